@@ -1,55 +1,5 @@
 #include "TWI.h"
 
-/**
- * @brief Constructor for the __TWI__ class.
- * 
- * This constructor initializes the __TWI__ object with the addresses of the TWI (I2C)
- * control registers. These registers are used to configure and control the I2C peripheral
- * for communication on the bus.
- * 
- * @param twbr Pointer to the TWI Bit Rate Register (TWBR).
- * @param twsr Pointer to the TWI Status Register (TWSR).
- * @param twar Pointer to the TWI Address Register (TWAR).
- * @param twdr Pointer to the TWI Data Register (TWDR).
- * @param twcr Pointer to the TWI Control Register (TWCR).
- * @param twamr Pointer to the TWI Address Mask Register (TWAMR).
- * 
- * This constructor sets up the internal pointers to the TWI registers, allowing
- * the class to access and modify them for managing I2C operations.
- */
-__TWI__::__TWI__(volatile uint8_t* twbr, volatile uint8_t* twsr, volatile uint8_t* twar, volatile uint8_t* twdr, volatile uint8_t* twcr, volatile uint8_t* twamr)
-{
-    this->twbr = twbr;
-    this->twsr = twsr;
-    this->twar = twar;
-    this->twdr = twdr;
-    this->twcr = twcr;
-    this->twamr = twamr;
-}
-
-
-/**
- * @brief Destructor for the __TWI__ class.
- * 
- * This destructor resets the internal pointers to the TWI (I2C) control registers 
- * by setting them to NULL. It ensures that the TWI interface is properly cleaned up 
- * when the __TWI__ object is destroyed, preventing any unintended access to the 
- * control registers after the object goes out of scope.
- * 
- * @note The destructor does not affect the hardware registers themselves, but only 
- * the internal pointers in the class.
- */
-__TWI__::~__TWI__()
-{
-    this->twbr = NULL;
-    this->twsr = NULL;
-    this->twar = NULL;
-    this->twdr = NULL;
-    this->twcr = NULL;
-    this->twamr = NULL;
-}
-
-
 /**
  * @brief Initializes the TWI (I2C) interface in master mode.
  * 
@@ -63,7 +13,8 @@ __TWI__::~__TWI__()
  * @return `1` if the initialization was successful, `0` if the TWI interface 
  *         was already initialized.
  */
-const uint8_t __TWI__::begin(const uint32_t frequency)
+template <class REGISTERS, uint16_t BUFFER_SIZE>
+const uint8_t __TWI__<REGISTERS, BUFFER_SIZE>::begin(const uint32_t frequency)
 {
     if (this->began)  /**< Check if the TWI interface has already been initialized. */
         return (0);  /**< Return 0 if already initialized. */
@@ -78,7 +29,7 @@ const uint8_t __TWI__::begin(const uint32_t frequency)
     this->setFrequency(frequency);  /**< Set the I2C frequency. */
 
     ATOMIC_BLOCK(ATOMIC_FORCEON)  /**< Begin atomic block to prevent interrupt interference. */
-        *this->twcr = TWI_BEGIN;  /**< Set the control register to start TWI communication. */
+        this->control(TWI_BEGIN);  /**< Set the control register to start TWI communication. */
 
     return (1);  /**< Return 1 to indicate success. */
 }
@@ -102,12 +53,47 @@ const uint8_t __TWI__::begin(const uint32_t frequency)
  * 
  * @see begin(uint32_t frequency) for more control over the frequency setting.
  */
-const uint8_t __TWI__::begin(void)
+template <class REGISTERS, uint16_t BUFFER_SIZE>
+const uint8_t __TWI__<REGISTERS, BUFFER_SIZE>::begin(void)
 {
     return (this->begin(TWI_DEFAULT_FREQUENCY));
 }
 
 
+/**
+ * @brief Initializes the TWI (I2C) interface in master mode with precomputed clock settings.
+ * 
+ * This function works like `begin(uint32_t frequency)` but takes the TWBR/TWPS pair 
+ * computed at compile time, avoiding the 32-bit division on the 8-bit core and allowing 
+ * prescaled low rates as well as 1 MHz Fast-mode Plus.
+ * 
+ * @param clock The clock settings, e.g. `TWI_BitRate<TWI_FAST_MODE_PLUS>::clock()`.
+ * 
+ * @return `1` if the initialization was successful, `0` if the TWI interface 
+ *         was already initialized.
+ */
+template <class REGISTERS, uint16_t BUFFER_SIZE>
+const uint8_t __TWI__<REGISTERS, BUFFER_SIZE>::begin(const TWI_Clock clock)
+{
+    if (this->began)  /**< Check if the TWI interface has already been initialized. */
+        return (0);  /**< Return 0 if already initialized. */
+
+    this->began = 1;  /**< Mark the interface as initialized. */
+
+    this->role = TWI_ROLE_MASTER;  /**< Set the role to master. */
+    this->state = TWI_READY;  /**< Set the state to 'ready'. */
+    this->sendStop = 1;  /**< Enable sending STOP after communication. */
+    this->inRepStart = 0;  /**< Reset the repeated start flag. */
+
+    this->setClock(clock);  /**< Set the I2C clock. */
+
+    ATOMIC_BLOCK(ATOMIC_FORCEON)  /**< Begin atomic block to prevent interrupt interference. */
+        this->control(TWI_BEGIN);  /**< Set the control register to start TWI communication. */
+
+    return (1);  /**< Return 1 to indicate success. */
+}
+
+
 /**
  * @brief Initializes the TWI (I2C) interface in slave mode with the specified address.
  * 
@@ -130,7 +116,31 @@ const uint8_t __TWI__::begin(void)
  * @see begin(uint32_t frequency) for master mode initialization, or begin() 
  *      for default frequency initialization in master mode.
  */
-const uint8_t __TWI__::begin(const uint8_t address)
+template <class REGISTERS, uint16_t BUFFER_SIZE>
+const uint8_t __TWI__<REGISTERS, BUFFER_SIZE>::begin(const uint8_t address)
+{
+    return (this->begin(address, (const uint8_t)0));  /**< Answer exactly one address. */
+}
+
+
+/**
+ * @brief Initializes the TWI (I2C) interface in slave mode answering a set of addresses.
+ * 
+ * This function works like `begin(address)` but also programs the TWI Address Mask 
+ * Register (TWAMR). Every bit set in `mask` is ignored when comparing the received 
+ * address with `address`, so one peripheral answers a whole set or range of addresses 
+ * (e.g. address `0x20` with mask `0x07` answers `0x20` to `0x27`). The address actually 
+ * used by the master is available from `getMatchedAddress()` and selects the handler 
+ * registered with `setSlaveHandlers()`.
+ * 
+ * @param address The 7-bit base address of this device in slave mode.
+ * @param mask The 7-bit mask of address bits to ignore.
+ * 
+ * @return `1` if the initialization was successful, `0` if the TWI interface 
+ *         was already initialized.
+ */
+template <class REGISTERS, uint16_t BUFFER_SIZE>
+const uint8_t __TWI__<REGISTERS, BUFFER_SIZE>::begin(const uint8_t address, const uint8_t mask)
 {
     if (this->began)  /**< Check if the TWI interface has already been initialized. */
         return (0);  /**< Return 0 if already initialized. */
@@ -142,8 +152,9 @@ const uint8_t __TWI__::begin(const uint8_t address)
 
     ATOMIC_BLOCK(ATOMIC_FORCEON)  /**< Begin atomic block to prevent interrupt interference. */
     {
-        *this->twar = this->address;  /**< Set the TWI address register to the configured address. */
-        *this->twcr = TWI_BEGIN;  /**< Set the control register to start TWI communication in slave mode. */
+        REGISTERS::twar() = this->address;  /**< Set the TWI address register to the configured address. */
+        REGISTERS::twamr() = mask << 1;  /**< Set the TWI address mask register, aligned like the address. */
+        this->control(TWI_BEGIN);  /**< Set the control register to start TWI communication in slave mode. */
     }
 
     return (1);  /**< Return 1 to indicate success. */
@@ -165,16 +176,44 @@ const uint8_t __TWI__::begin(const uint8_t address)
  * @return `1` if the frequency was successfully set, `0` if the TWI interface is 
  *         not in master mode.
  */
-const uint8_t __TWI__::setFrequency(const uint32_t frequency)
+template <class REGISTERS, uint16_t BUFFER_SIZE>
+const uint8_t __TWI__<REGISTERS, BUFFER_SIZE>::setFrequency(const uint32_t frequency)
 {
     if (this->role != TWI_ROLE_MASTER)  /**< Check if the TWI is not in master mode. */
         return (0);  /**< Return 0 if the TWI is not in master mode. */
 
-    this->frequency = frequency;  /**< Set the desired communication frequency. */
-
-    *this->twbr = ((F_CPU / this->frequency) - 16) / 2;  /**< Calculate and set the Bit Rate Register for the TWI frequency. */
+    TWI_Clock clock;
+    clock.twbr = ((F_CPU / frequency) - 16) / 2;  /**< Calculate the Bit Rate Register for the TWI frequency, only the result is kept. */
+    clock.twps = 0;  /**< Without prescaler. */
     
-    return (1);  /**< Return 1 to indicate that the frequency was successfully set. */
+    return (this->setClock(clock));  /**< Apply the clock settings. */
+}
+
+
+/**
+ * @brief Sets the bus clock of the TWI (I2C) interface from precomputed settings.
+ * 
+ * Unlike `setFrequency()`, no division is done at runtime; the settings are usually 
+ * computed at compile time with `TWI_BitRate`. They become the bus clock used by every 
+ * transaction that has no clock profile of its own.
+ * 
+ * @param clock The TWBR/TWPS settings, e.g. `TWI_BitRate<TWI_FAST_MODE>::clock()`.
+ * 
+ * @return `1` if the clock was successfully set, `0` if the TWI interface is 
+ *         not in master mode.
+ */
+template <class REGISTERS, uint16_t BUFFER_SIZE>
+const uint8_t __TWI__<REGISTERS, BUFFER_SIZE>::setClock(const TWI_Clock clock)
+{
+    if (this->role != TWI_ROLE_MASTER)  /**< Check if the TWI is not in master mode. */
+        return (0);  /**< Return 0 if the TWI is not in master mode. */
+
+    this->clock = clock;  /**< Remember the bus clock. */
+
+    REGISTERS::twbr() = clock.twbr;  /**< Set the Bit Rate Register. */
+    REGISTERS::twsr() = clock.twps;  /**< Set the prescaler bits, the status bits are read-only. */
+
+    return (1);  /**< Return 1 to indicate that the clock was successfully set. */
 }
 
 
@@ -192,15 +231,30 @@ const uint8_t __TWI__::setFrequency(const uint32_t frequency)
  *         interface is not in master mode or if the transmission could not 
  *         be started.
  */
-const uint8_t __TWI__::beginTransmission(const uint8_t address)
+template <class REGISTERS, uint16_t BUFFER_SIZE>
+const uint8_t __TWI__<REGISTERS, BUFFER_SIZE>::beginTransmission(const uint8_t address)
 {
     if (this->role != TWI_ROLE_MASTER)  /**< Check if the TWI is not in master mode. */
         return (0);  /**< Return 0 if the TWI is not in master mode. */
 
-    while (this->state != TWI_READY);  /**< Wait for the TWI interface to be ready for transmission. */
-    
-    this->state = TWI_MTX;  /**< Set the state to master transmit mode. */
-    this->address = (address << 1) | TW_WRITE;  /**< Prepare the address for writing by shifting it left and setting the write bit. */
+    uint8_t claimed = 0;  /**< Flag indicating whether the bus was claimed for the transmission. */
+
+    while (!claimed)
+    {
+        if (!this->idle())  /**< Wait until TWI state is ready, give up if the bus made no progress. */
+            return (0);  /**< Return 0 if the bus timed out. */
+
+        ATOMIC_BLOCK(ATOMIC_RESTORESTATE)  /**< A timer calling scan() may take the bus after idle() returned... */
+        {
+            if (this->state == TWI_READY)  /**< ...so claim it only if it is still ready. */
+            {
+                this->state = TWI_MTX;  /**< Set the state to master transmit mode. */
+                claimed = 1;
+            }
+        }
+    }
+
+    this->transfer.address = address;  /**< Remember the address of the device to write to. */
     this->bufferIndex = 0;  /**< Reset the buffer index to the beginning for storing transmitted data. */
     this->bufferSize = 0;  /**< Initialize the buffer size to zero, indicating no data yet in the buffer. */
     
@@ -221,9 +275,10 @@ const uint8_t __TWI__::beginTransmission(const uint8_t address)
  * @return `1` if the byte was successfully written to the buffer, `0` if 
  *         the buffer is full and cannot accommodate more data.
  */
-const uint8_t __TWI__::write(const uint8_t byte)
+template <class REGISTERS, uint16_t BUFFER_SIZE>
+const uint8_t __TWI__<REGISTERS, BUFFER_SIZE>::write(const uint8_t byte)
 {
-    if (this->bufferSize >= TWI_BUFFER_SIZE)  /**< Check if the buffer has reached its maximum size. */
+    if (this->bufferSize >= BUFFER_SIZE)  /**< Check if the buffer has reached its maximum size. */
         return (0);  /**< Return 0 if the buffer is full and cannot accept more data. */
     
     this->buffer[this->bufferSize++] = byte;  /**< Add the byte to the buffer and increment the buffer size. */
@@ -246,7 +301,8 @@ const uint8_t __TWI__::write(const uint8_t byte)
  * @return `1` if all bytes were successfully written to the buffer, `0` if 
  *         any byte failed to be written due to the buffer being full.
  */
-const uint8_t __TWI__::write(const uint8_t* bytes, const uint8_t size)
+template <class REGISTERS, uint16_t BUFFER_SIZE>
+const uint8_t __TWI__<REGISTERS, BUFFER_SIZE>::write(const uint8_t* bytes, const length_t size)
 {
     for (const uint8_t* p = bytes; p < (bytes + size); p++)  /**< Loop through each byte in the input array. */
         if (!this->write(*p))  /**< Try to write the current byte to the buffer. If it fails, return 0. */
@@ -271,7 +327,8 @@ const uint8_t __TWI__::write(const uint8_t* bytes, const uint8_t size)
  * @return `1` if all bytes were successfully written to the buffer, `0` if 
  *         any byte failed to be written due to the buffer being full.
  */
-const uint8_t __TWI__::write(const void* data, const uint8_t size)
+template <class REGISTERS, uint16_t BUFFER_SIZE>
+const uint8_t __TWI__<REGISTERS, BUFFER_SIZE>::write(const void* data, const length_t size)
 {
     return (this->write((const uint8_t*)data, size));  /**< Cast the data pointer to uint8_t* and call the byte-array write function. */
 }
@@ -293,29 +350,18 @@ const uint8_t __TWI__::write(const void* data, const uint8_t size)
  *                 a repeated START condition (`0`).
  * 
  * @return `1` if the transmission ended successfully, `0` if the role is not master.
+ * 
+ * @see startTransmission(uint8_t sendStop) for the non-blocking variant.
  */
-const uint8_t __TWI__::endTransmission(const uint8_t sendStop)
+template <class REGISTERS, uint16_t BUFFER_SIZE>
+const uint8_t __TWI__<REGISTERS, BUFFER_SIZE>::endTransmission(const uint8_t sendStop)
 {
-    if (this->role != TWI_ROLE_MASTER)  /**< Check if the role is master; if not, return 0. */
+    if (!this->startTransmission(sendStop))  /**< Hand the transmission over to the ISR; return 0 if not master. */
         return (0);
 
-    this->sendStop = sendStop;  /**< Set the sendStop flag to the provided value. */
-    
-    // If we're in a repeated start, we've already sent the START in the ISR. Don't do it again.
-    if (this->inRepStart)  /**< Check if we are in a repeated start condition. */
-    {
-        // In the repeated start state, the start condition has already been sent.
-        // We need to clean up before enabling interrupts.
-        this->inRepStart = 0;  /**< Reset the repeated start flag. */
-        *this->twdr = this->address;  /**< Write the address to the data register. */
-        *this->twcr = TWI_SEND_ACK;  /**< Send an ACK to continue the transmission. */
-    }
-    else
-        *this->twcr = TWI_SEND_START;  /**< Send the START condition. */
-
-    while(this->state == TWI_MTX);  /**< Wait until the transmission is complete (not in master transmit mode). */
+    this->wait(&this->transfer, this->timeout);  /**< Wait until the transmission is complete, recover the bus if it made no progress. */
     
-    return (this->status);  /**< Return the transmission status. */
+    return (this->transfer.status);  /**< Return the transmission status. */
 }
 
 
@@ -329,12 +375,159 @@ const uint8_t __TWI__::endTransmission(const uint8_t sendStop)
  * 
  * @return `1` if the transmission ended successfully, `0` if the role is not master.
  */
-const uint8_t __TWI__::endTransmission(void)
+template <class REGISTERS, uint16_t BUFFER_SIZE>
+const uint8_t __TWI__<REGISTERS, BUFFER_SIZE>::endTransmission(void)
 {
     return (this->endTransmission((const uint8_t)1));  /**< Call the `endTransmission` with `sendStop` set to 1 to send the STOP condition. */
 }
 
 
+/**
+ * @brief Starts the transmission of the buffered data without waiting for it to finish.
+ * 
+ * This function hands the data collected with `beginTransmission()` and `write()` over 
+ * to the interrupt service routine and returns immediately. The transfer is then driven 
+ * entirely by `isr()`, leaving the CPU free while bytes are on the wire. Completion can be 
+ * detected by polling `isBusy()` or through the callback set with `setDoneCallback()`; the 
+ * resulting TWI status is available from `getStatus()`.
+ * 
+ * @param sendStop A flag that determines whether to send a STOP condition (`1`) or 
+ *                 a repeated START condition (`0`) once all data was sent.
+ * 
+ * @return `1` if the transmission was started, `0` if the role is not master.
+ */
+template <class REGISTERS, uint16_t BUFFER_SIZE>
+const uint8_t __TWI__<REGISTERS, BUFFER_SIZE>::startTransmission(const uint8_t sendStop)
+{
+    if (this->role != TWI_ROLE_MASTER)  /**< Check if the role is master; if not, return 0. */
+        return (0);
+
+    this->transfer.txData = (const uint8_t*)this->buffer;  /**< Transmit straight from the internal buffer. */
+    this->transfer.txLength = this->bufferSize;  /**< Transmit everything that was written. */
+    this->transfer.rxLength = 0;  /**< Nothing to receive. */
+
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)  /**< Prevent the ISR from seeing a half prepared transaction. */
+    {
+        this->load(&this->transfer, sendStop);  /**< Prepare the buffered transfer for the ISR. */
+        this->launch();  /**< Put it on the bus. */
+    }
+
+    return (1);  /**< Return 1 to indicate the transmission is in flight. */
+}
+
+
+/**
+ * @brief Starts the transmission of the buffered data followed by a STOP condition.
+ * 
+ * This function is the non-blocking counterpart of `endTransmission(void)`. It simply 
+ * calls `startTransmission` with the `sendStop` flag set to `1`.
+ * 
+ * @return `1` if the transmission was started, `0` if the role is not master.
+ */
+template <class REGISTERS, uint16_t BUFFER_SIZE>
+const uint8_t __TWI__<REGISTERS, BUFFER_SIZE>::startTransmission(void)
+{
+    return (this->startTransmission((const uint8_t)1));  /**< Call the `startTransmission` with `sendStop` set to 1. */
+}
+
+
+/**
+ * @brief Starts the transmission of caller-owned data without copying it.
+ * 
+ * Unlike `beginTransmission()`/`write()`, this function does not copy the data into the 
+ * internal buffer. The ISR reads every byte straight from `data`, so the transfer is not 
+ * limited to `BUFFER_SIZE` bytes. The function returns as soon as the START was issued; 
+ * `data` must stay valid until `isBusy()` returns `0`.
+ * 
+ * @param address The 7-bit address of the TWI slave device to write to.
+ * @param data Pointer to the bytes to transmit.
+ * @param size The number of bytes to transmit.
+ * @param sendStop A flag that determines whether to send a STOP condition (`1`) or 
+ *                 a repeated START condition (`0`) once all data was sent.
+ * 
+ * @return `1` if the transmission was started, `0` if the role is not master.
+ */
+template <class REGISTERS, uint16_t BUFFER_SIZE>
+const uint8_t __TWI__<REGISTERS, BUFFER_SIZE>::startTransmission(const uint8_t address, const void* data, const uint16_t size, const uint8_t sendStop)
+{
+    if (this->role != TWI_ROLE_MASTER)  /**< Check if the role is master; if not, return 0. */
+        return (0);
+
+    if (!this->idle())  /**< Wait until TWI state is ready, give up if the bus made no progress. */
+        return (0);  /**< Return 0 if the bus timed out. */
+
+    this->transfer.address = address;  /**< Remember the address of the device to write to. */
+    this->transfer.txData = (const uint8_t*)data;  /**< Transmit straight from the caller's memory. */
+    this->transfer.txLength = size;  /**< Transmit all of it. */
+    this->transfer.rxLength = 0;  /**< Nothing to receive. */
+
+    return (this->submit(sendStop));  /**< Put it on the bus, return 1 to indicate the transmission is in flight. */
+}
+
+
+/**
+ * @brief Starts the transmission of caller-owned data followed by a STOP condition.
+ * 
+ * This function calls the full `startTransmission` with the `sendStop` flag set to `1`.
+ * 
+ * @param address The 7-bit address of the TWI slave device to write to.
+ * @param data Pointer to the bytes to transmit.
+ * @param size The number of bytes to transmit.
+ * 
+ * @return `1` if the transmission was started, `0` if the role is not master.
+ */
+template <class REGISTERS, uint16_t BUFFER_SIZE>
+const uint8_t __TWI__<REGISTERS, BUFFER_SIZE>::startTransmission(const uint8_t address, const void* data, const uint16_t size)
+{
+    return (this->startTransmission(address, data, size, (const uint8_t)1));  /**< Call the full startTransmission with sendStop set to 1. */
+}
+
+
+/**
+ * @brief Transmits caller-owned data without copying it and waits for the result.
+ * 
+ * This function is the blocking counterpart of `startTransmission(address, data, size, sendStop)`. 
+ * It is equivalent to `beginTransmission()`, `write()` and `endTransmission()` without the 
+ * copy into the internal buffer.
+ * 
+ * @param address The 7-bit address of the TWI slave device to write to.
+ * @param data Pointer to the bytes to transmit.
+ * @param size The number of bytes to transmit.
+ * @param sendStop A flag that determines whether to send a STOP condition (`1`) or 
+ *                 a repeated START condition (`0`) once all data was sent.
+ * 
+ * @return The transmission status, `0` if the role is not master.
+ */
+template <class REGISTERS, uint16_t BUFFER_SIZE>
+const uint8_t __TWI__<REGISTERS, BUFFER_SIZE>::transmit(const uint8_t address, const void* data, const uint16_t size, const uint8_t sendStop)
+{
+    if (!this->startTransmission(address, data, size, sendStop))  /**< Hand the transmission over to the ISR; return 0 if not master. */
+        return (0);
+
+    this->wait(&this->transfer, this->timeout);  /**< Wait until the transmission is complete, recover the bus if it made no progress. */
+
+    return (this->transfer.status);  /**< Return the transmission status. */
+}
+
+
+/**
+ * @brief Transmits caller-owned data followed by a STOP condition and waits for the result.
+ * 
+ * This function calls the full `transmit` with the `sendStop` flag set to `1`.
+ * 
+ * @param address The 7-bit address of the TWI slave device to write to.
+ * @param data Pointer to the bytes to transmit.
+ * @param size The number of bytes to transmit.
+ * 
+ * @return The transmission status, `0` if the role is not master.
+ */
+template <class REGISTERS, uint16_t BUFFER_SIZE>
+const uint8_t __TWI__<REGISTERS, BUFFER_SIZE>::transmit(const uint8_t address, const void* data, const uint16_t size)
+{
+    return (this->transmit(address, data, size, (const uint8_t)1));  /**< Call the full transmit with sendStop set to 1. */
+}
+
+
 /**
  * @brief Requests data from a slave device on the I2C bus.
  * 
@@ -348,47 +541,25 @@ const uint8_t __TWI__::endTransmission(void)
  * @param sendStop A flag to indicate whether a STOP condition should be sent after 
  *                 the request (default is `1` to send STOP, `0` to keep the bus open).
  * 
- * @return The number of bytes received or `255` if the requested quantity exceeds 
- *         the buffer size. Returns `0` if the role is not master.
+ * @return The number of bytes received or the maximum length value (`255` for 8-bit 
+ *         lengths) if the requested quantity exceeds the buffer size. Returns `0` if 
+ *         the role is not master.
+ * 
+ * @see startRequest(uint8_t address, uint8_t quantity, uint8_t sendStop) for the 
+ *      non-blocking variant.
  */
-const uint8_t __TWI__::requestFrom(const uint8_t address, uint8_t quantity, const uint8_t sendStop)
+template <class REGISTERS, uint16_t BUFFER_SIZE>
+const typename __TWI__<REGISTERS, BUFFER_SIZE>::length_t __TWI__<REGISTERS, BUFFER_SIZE>::requestFrom(const uint8_t address, length_t quantity, const uint8_t sendStop)
 {
-    if (this->role != TWI_ROLE_MASTER)  /**< Check if the role is MASTER, return 0 if not. */
-        return (0);
+    if (quantity > BUFFER_SIZE)  /**< Check if requested quantity exceeds buffer size, return the maximum length if true. */
+        return ((length_t)~0);
 
-    if (quantity > TWI_BUFFER_SIZE)  /**< Check if requested quantity exceeds buffer size, return 255 if true. */
-        return (255);
-
-    while (this->state != TWI_READY);  /**< Wait until TWI state is ready. */
-    this->state = TWI_MRX;  /**< Set state to master receiver (MRX). */
-    this->sendStop = sendStop;  /**< Set the sendStop flag to determine whether to send a STOP condition. */
-    this->bufferIndex = 0;  /**< Reset buffer index. */
-    
-    // Set buffer size to quantity - 1 because we will handle the last byte differently
-    this->bufferSize = quantity - 1;  
-
-    this->address = (address << 1) | TW_READ;  /**< Set the address for reading (shifted and added TW_READ). */
-
-    // Handle repeated start if needed.
-    if (this->inRepStart)  /**< If we are in a repeated start state... */
-    {
-        this->inRepStart = 0;  /**< Clear repeated start flag. */
-        *this->twdr = this->address;  /**< Write the address to the TWI data register. */
-        *this->twcr = TWI_SEND_ACK;  /**< Send ACK and continue. */
-    }
-    else
-        *this->twcr = TWI_SEND_START;  /**< Send start condition for a normal request. */
-
-    while(this->state == TWI_MRX);  /**< Wait until the data reception is completed. */
+    if (!this->startRequest(address, quantity, sendStop))  /**< Hand the request over to the ISR; return 0 if it was refused. */
+        return (0);
 
-    // Adjust quantity based on the actual number of received bytes
-    if (this->bufferIndex < quantity)  /**< If fewer bytes were received than requested... */
-        quantity = this->bufferIndex;  /**< Adjust requested quantity to the actual received quantity. */
+    this->wait(&this->transfer, this->timeout);  /**< Wait until the data reception is completed, recover the bus if it made no progress. */
     
-    this->bufferSize = quantity;  /**< Update buffer size with the number of received bytes. */
-    this->bufferIndex = 0;  /**< Reset buffer index for next operation. */
-    
-    return (quantity);  /**< Return the number of bytes received. */
+    return (this->bufferSize);  /**< Return the number of bytes received. */
 }
 
 
@@ -406,259 +577,1864 @@ const uint8_t __TWI__::requestFrom(const uint8_t address, uint8_t quantity, cons
  * @return The number of bytes received, or `255` if the requested quantity exceeds 
  *         the buffer size. Returns `0` if the role is not master.
  */
-const uint8_t __TWI__::requestFrom(const uint8_t address, uint8_t quantity)
+template <class REGISTERS, uint16_t BUFFER_SIZE>
+const typename __TWI__<REGISTERS, BUFFER_SIZE>::length_t __TWI__<REGISTERS, BUFFER_SIZE>::requestFrom(const uint8_t address, length_t quantity)
 {
     return (this->requestFrom(address, quantity, (const uint8_t)1));  /**< Call the full requestFrom with sendStop set to 1. */
 }
 
 
 /**
- * @brief Returns the number of bytes available in the receive buffer.
+ * @brief Starts a request for data from a slave device without waiting for it to finish.
  * 
- * This function calculates the number of bytes that have been successfully received
- * from the slave device and stored in the buffer, but not yet read by the user. It 
- * subtracts the current index from the total buffer size to provide the number of 
- * remaining bytes available for reading.
+ * This function prepares the TWI interface for reception and issues the START condition, 
+ * then returns immediately. The bytes are collected into the internal buffer by `isr()`. 
+ * Once `isBusy()` returns `0` (or the callback set with `setDoneCallback()` fired), the 
+ * received bytes can be drained with `available()` and `read()`.
  * 
- * @return The number of bytes available in the buffer for reading.
+ * @param address The I2C address of the slave device.
+ * @param quantity The number of bytes to request from the slave device.
+ * @param sendStop A flag to indicate whether a STOP condition should be sent after 
+ *                 the request (`1` to send STOP, `0` to keep the bus open).
+ * 
+ * @return `1` if the request was started, `0` if the role is not master or the 
+ *         quantity is zero or exceeds the buffer size.
  */
-const uint8_t __TWI__::available(void)
+template <class REGISTERS, uint16_t BUFFER_SIZE>
+const uint8_t __TWI__<REGISTERS, BUFFER_SIZE>::startRequest(const uint8_t address, const length_t quantity, const uint8_t sendStop)
 {
-    return (this->bufferSize - this->bufferIndex);  /**< Calculate available bytes by subtracting the current index from the buffer size. */
+    if (this->role != TWI_ROLE_MASTER)  /**< Check if the role is MASTER, return 0 if not. */
+        return (0);
+
+    if (!quantity || quantity > BUFFER_SIZE)  /**< Check if requested quantity fits the buffer, return 0 if not. */
+        return (0);
+
+    if (!this->idle())  /**< Wait until TWI state is ready, give up if the bus made no progress. */
+        return (0);  /**< Return 0 if the bus timed out. */
+
+    this->bufferIndex = 0;  /**< Reset buffer index. */
+    this->bufferSize = 0;  /**< Nothing can be read until the request has finished. */
+
+    this->transfer.address = address;  /**< Remember the address of the device to read from. */
+    this->transfer.txLength = 0;  /**< Nothing to transmit. */
+    this->transfer.rxData = (uint8_t*)this->buffer;  /**< Receive straight into the internal buffer. */
+    this->transfer.rxLength = quantity;  /**< Receive the requested number of bytes. */
+
+    return (this->submit(sendStop));  /**< Put it on the bus, return 1 to indicate the request is in flight. */
 }
 
 
 /**
- * @brief Reads a byte of data from the receive buffer.
+ * @brief Starts a request for data from a slave device followed by a STOP condition.
  * 
- * This function reads the next byte from the buffer, incrementing the buffer index.
- * If there are no more bytes available to read (i.e., the index exceeds the buffer size),
- * it returns 0.
+ * This function is the non-blocking counterpart of `requestFrom(address, quantity)`. 
+ * It forwards the request to the full `startRequest` function with the `sendStop` 
+ * parameter set to `1`.
  * 
- * @return The next byte of data from the buffer, or `0` if there are no more bytes to read.
+ * @param address The I2C address of the slave device.
+ * @param quantity The number of bytes to request from the slave device.
+ * 
+ * @return `1` if the request was started, `0` otherwise.
  */
-const uint8_t __TWI__::read(void)
+template <class REGISTERS, uint16_t BUFFER_SIZE>
+const uint8_t __TWI__<REGISTERS, BUFFER_SIZE>::startRequest(const uint8_t address, const length_t quantity)
 {
-    if (this->bufferIndex >= this->bufferSize)  /**< Check if all data has been read from the buffer. */
-        return (0);  /**< If no data is left, return 0. */
-    return (this->buffer[this->bufferIndex++]);  /**< Return the next byte and increment the buffer index. */
+    return (this->startRequest(address, quantity, (const uint8_t)1));  /**< Call the full startRequest with sendStop set to 1. */
 }
 
 
 /**
- * @brief Ends the current TWI (I2C) communication.
+ * @brief Requests data from a slave device straight into caller memory and waits for it.
  * 
- * This function stops any ongoing communication and resets the TWI interface to 
- * its initial state. It also restores the default role (master) and clears the address.
+ * Unlike `requestFrom(address, quantity)`, the ISR stores every received byte directly 
+ * into `destination`, so no `read()` calls are needed afterwards and the request is not 
+ * limited to `BUFFER_SIZE` bytes.
  * 
- * @return `1` if the operation was successful, `0` if the TWI interface was not 
- *         initialized previously.
+ * @param address The I2C address of the slave device.
+ * @param destination Pointer to the memory receiving the bytes.
+ * @param length The number of bytes to request from the slave device.
+ * @param sendStop A flag to indicate whether a STOP condition should be sent after 
+ *                 the request (`1` to send STOP, `0` to keep the bus open).
+ * 
+ * @return The number of bytes received, `0` if the request was refused.
  */
-const uint8_t __TWI__::end(void)
+template <class REGISTERS, uint16_t BUFFER_SIZE>
+const uint16_t __TWI__<REGISTERS, BUFFER_SIZE>::requestFrom(const uint8_t address, void* destination, const uint16_t length, const uint8_t sendStop)
 {
-    if (!this->began)  /**< Check if the TWI interface was initialized. */
-        return (0);  /**< Return 0 if not initialized. */
-    
-    this->began = 0;  /**< Mark the TWI interface as uninitialized. */
+    if (!this->startRequest(address, destination, length, sendStop))  /**< Hand the request over to the ISR; return 0 if it was refused. */
+        return (0);
 
-    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)  /**< Ensure atomic operation to prevent interruption during TWI operations. */
-    {
-        *this->twcr = TWI_END;  /**< Disable TWI communication. */
-        *this->twar = 0;  /**< Clear the TWI address register. */
-        *this->twcr = TWI_BEGIN;  /**< Re-enable TWI communication. */
-        *this->twbr = 0;  /**< Clear the TWI bit rate register. */
-        this->role = TWI_ROLE_MASTER;  /**< Set the role back to master. */
-        this->address = *this->twar;  /**< Store the address from the TWI address register. */
-    }
-        
-    return (1);  /**< Return 1 to indicate successful completion. */
+    this->wait(&this->transfer, this->timeout);  /**< Wait until the data reception is completed, recover the bus if it made no progress. */
+
+    return (this->transfer.count);  /**< Return the number of bytes received. */
 }
 
 
 /**
- * @brief Sets the callback function for receiving data with a specified size.
+ * @brief Requests data from a slave device straight into caller memory, followed by a STOP.
  * 
- * This function assigns a user-defined callback to be executed when data is received 
- * via TWI. The callback function should take a single `uint8_t` parameter, which 
- * represents the size of the received data.
+ * This function calls the full `requestFrom` with the `sendStop` flag set to `1`.
  * 
- * @param function The callback function to be executed when data is received. It 
- *                 should have the signature `void function(uint8_t size)` where 
- *                 `size` indicates the size of the received data.
+ * @param address The I2C address of the slave device.
+ * @param destination Pointer to the memory receiving the bytes.
+ * @param length The number of bytes to request from the slave device.
+ * 
+ * @return The number of bytes received, `0` if the request was refused.
  */
-void __TWI__::setRxCallback(void (*function)(const uint8_t size))
+template <class REGISTERS, uint16_t BUFFER_SIZE>
+const uint16_t __TWI__<REGISTERS, BUFFER_SIZE>::requestFrom(const uint8_t address, void* destination, const uint16_t length)
 {
-    this->rxCallback = function;  /**< Store the provided function in the rxCallback member. */
+    return (this->requestFrom(address, destination, length, (const uint8_t)1));  /**< Call the full requestFrom with sendStop set to 1. */
 }
 
+
 /**
- * @brief Sets the callback function for transmitting data.
+ * @brief Starts a request for data straight into caller memory without waiting for it.
  * 
- * This function assigns a user-defined callback to be executed when the TWI is ready 
- * to transmit data. The callback function does not take any parameters.
+ * The ISR stores every received byte directly into `destination`, which must stay valid 
+ * until `isBusy()` returns `0`. The number of bytes received is then available from 
+ * `received()`.
  * 
- * @param function The callback function to be executed when TWI is ready to transmit. 
- *                 It should have the signature `void function()`.
+ * @param address The I2C address of the slave device.
+ * @param destination Pointer to the memory receiving the bytes.
+ * @param length The number of bytes to request from the slave device.
+ * @param sendStop A flag to indicate whether a STOP condition should be sent after 
+ *                 the request (`1` to send STOP, `0` to keep the bus open).
+ * 
+ * @return `1` if the request was started, `0` if the role is not master or the 
+ *         length is zero.
  */
-void __TWI__::setTxCallback(void (*function)(void))
+template <class REGISTERS, uint16_t BUFFER_SIZE>
+const uint8_t __TWI__<REGISTERS, BUFFER_SIZE>::startRequest(const uint8_t address, void* destination, const uint16_t length, const uint8_t sendStop)
 {
-    this->txCallback = function;  /**< Store the provided function in the txCallback member. */
+    if (this->role != TWI_ROLE_MASTER)  /**< Check if the role is MASTER, return 0 if not. */
+        return (0);
+
+    if (!length)  /**< Check if there is anything to receive, return 0 if not. */
+        return (0);
+
+    if (!this->idle())  /**< Wait until TWI state is ready, give up if the bus made no progress. */
+        return (0);  /**< Return 0 if the bus timed out. */
+
+    this->transfer.address = address;  /**< Remember the address of the device to read from. */
+    this->transfer.txLength = 0;  /**< Nothing to transmit. */
+    this->transfer.rxData = (uint8_t*)destination;  /**< Receive straight into the caller's memory. */
+    this->transfer.rxLength = length;  /**< Receive the requested number of bytes. */
+
+    return (this->submit(sendStop));  /**< Put it on the bus, return 1 to indicate the request is in flight. */
 }
 
 
 /**
- * @brief Interrupt Service Routine (ISR) for handling TWI events.
+ * @brief Starts a request for data straight into caller memory, followed by a STOP.
  * 
- * This function is called when a TWI interrupt occurs, and it handles the 
- * different TWI events, such as START, STOP, data reception, and transmission 
- * for both master and slave modes. It manages the internal state of the TWI 
- * interface and interacts with buffers and callback functions.
+ * This function calls the full `startRequest` with the `sendStop` flag set to `1`.
+ * 
+ * @param address The I2C address of the slave device.
+ * @param destination Pointer to the memory receiving the bytes.
+ * @param length The number of bytes to request from the slave device.
+ * 
+ * @return `1` if the request was started, `0` otherwise.
  */
-void __TWI__::isr(void)
+template <class REGISTERS, uint16_t BUFFER_SIZE>
+const uint8_t __TWI__<REGISTERS, BUFFER_SIZE>::startRequest(const uint8_t address, void* destination, const uint16_t length)
 {
-    this->status = *this->twsr & 0xF8;  /**< Read the status of TWI from TWSR register. */
-    
-    switch (this->status)  /**< Handle different status cases based on the TWI event. */
+    return (this->startRequest(address, destination, length, (const uint8_t)1));  /**< Call the full startRequest with sendStop set to 1. */
+}
+
+
+/**
+ * @brief Writes to a slave device and reads back its answer as a single transaction.
+ * 
+ * This is the usual way to read a device register: `size` bytes from `source` (typically 
+ * the register number) are written, then the ISR issues a repeated START and reads `length` 
+ * bytes straight into `destination`, without a foreground round trip in between.
+ * 
+ * @param address The I2C address of the slave device.
+ * @param source Pointer to the bytes to write first.
+ * @param size The number of bytes to write.
+ * @param destination Pointer to the memory receiving the bytes.
+ * @param length The number of bytes to read.
+ * 
+ * @return The number of bytes received, `0` if the transaction was refused or the 
+ *         device did not answer.
+ */
+template <class REGISTERS, uint16_t BUFFER_SIZE>
+const uint16_t __TWI__<REGISTERS, BUFFER_SIZE>::writeThenRead(const uint8_t address, const void* source, const uint16_t size, void* destination, const uint16_t length)
+{
+    if (!this->startWriteThenRead(address, source, size, destination, length))  /**< Hand the transaction over to the ISR; return 0 if it was refused. */
+        return (0);
+
+    this->wait(&this->transfer, this->timeout);  /**< Wait until the transaction is completed, recover the bus if it made no progress. */
+
+    return (this->transfer.count);  /**< Return the number of bytes received. */
+}
+
+
+/**
+ * @brief Starts a write followed by a repeated START and a read without waiting for it.
+ * 
+ * This function is the non-blocking counterpart of `writeThenRead()`. Both buffers must 
+ * stay valid until `isBusy()` returns `0`; the number of bytes received is then available 
+ * from `received()`.
+ * 
+ * @param address The I2C address of the slave device.
+ * @param source Pointer to the bytes to write first.
+ * @param size The number of bytes to write.
+ * @param destination Pointer to the memory receiving the bytes.
+ * @param length The number of bytes to read.
+ * 
+ * @return `1` if the transaction was started, `0` if the role is not master or 
+ *         either part is empty.
+ */
+template <class REGISTERS, uint16_t BUFFER_SIZE>
+const uint8_t __TWI__<REGISTERS, BUFFER_SIZE>::startWriteThenRead(const uint8_t address, const void* source, const uint16_t size, void* destination, const uint16_t length)
+{
+    if (this->role != TWI_ROLE_MASTER)  /**< Check if the role is MASTER, return 0 if not. */
+        return (0);
+
+    if (!size || !length)  /**< Check if there is something to write and to read, return 0 if not. */
+        return (0);
+
+    if (!this->idle())  /**< Wait until TWI state is ready, give up if the bus made no progress. */
+        return (0);  /**< Return 0 if the bus timed out. */
+
+    this->transfer.address = address;  /**< Remember the address of the device. */
+    this->transfer.txData = (const uint8_t*)source;  /**< Transmit straight from the caller's memory. */
+    this->transfer.txLength = size;  /**< Transmit all of it. */
+    this->transfer.rxData = (uint8_t*)destination;  /**< Receive straight into the caller's memory. */
+    this->transfer.rxLength = length;  /**< Receive the requested number of bytes. */
+
+    return (this->submit(1));  /**< Put it on the bus, return 1 to indicate the transaction is in flight. */
+}
+
+
+/**
+ * @brief Returns the number of bytes transferred by the last non-blocking transaction.
+ * 
+ * After `isBusy()` returned `0`, this is the number of bytes actually written or 
+ * received, which may be less than requested if the slave NACKed early.
+ * 
+ * @return The number of transferred bytes.
+ */
+template <class REGISTERS, uint16_t BUFFER_SIZE>
+const uint16_t __TWI__<REGISTERS, BUFFER_SIZE>::received(void)
+{
+    return (this->transfer.count);  /**< Return the number of bytes the ISR transferred. */
+}
+
+
+/**
+ * @brief Checks whether a master transaction is still in flight.
+ * 
+ * This function is the pollable handle of the non-blocking API. It reports whether 
+ * the ISR is still working on a transaction started with `startTransmission()` or 
+ * `startRequest()`. In polling mode it also drives the transaction via `poll()`.
+ * 
+ * @return `1` if the transaction is still in flight, `0` if it has finished.
+ */
+template <class REGISTERS, uint16_t BUFFER_SIZE>
+const uint8_t __TWI__<REGISTERS, BUFFER_SIZE>::isBusy(void)
+{
+    this->poll();  /**< In polling mode, move the transaction along. */
+
+    return (!this->transfer.done);  /**< Busy until the ISR marked the buffered transfer as done. */
+}
+
+
+/**
+ * @brief Runs the TWI state machine from the foreground in polling mode.
+ * 
+ * In polling mode TWIE is never set, so nothing happens on the bus unless this function 
+ * is called: whenever TWINT is set, it performs the very same transition the ISR would. 
+ * The blocking calls and `isBusy()` call it on their own; applications using the queue 
+ * or slave mode call it from their main loop. This works with interrupts disabled and 
+ * avoids the interrupt entry and context save per byte. In interrupt driven mode the 
+ * function does nothing.
+ * 
+ * @return `1` if a TWI event was handled, `0` otherwise.
+ */
+template <class REGISTERS, uint16_t BUFFER_SIZE>
+const uint8_t __TWI__<REGISTERS, BUFFER_SIZE>::poll(void)
+{
+    if (this->controlMask & (1 << TWIE))  /**< Interrupt driven, the ISR does the work. */
+        return (0);
+
+    if (this->inRepStart || !(REGISTERS::twcr() & (1 << TWINT)))  /**< Nothing happened, or the bus is held for the next transaction. */
+        return (0);
+
+    this->isr();  /**< Handle the event right here. */
+
+    return (1);  /**< Return 1 to indicate an event was handled. */
+}
+
+
+/**
+ * @brief Switches between interrupt driven and polling mode.
+ * 
+ * In polling mode the TWI interrupt is never enabled and the foreground drives every 
+ * transition by watching TWINT (see `poll()`). Short transactions finish with less 
+ * latency and can run where interrupts are disabled. The mode can be switched around a 
+ * single call; the default is interrupt driven, or polling if `TWI_POLLING` is defined.
+ * 
+ * @param enabled `1` for polling mode, `0` for interrupt driven mode.
+ * 
+ * @return `1` if the mode was switched, `0` if a transaction is in flight.
+ */
+template <class REGISTERS, uint16_t BUFFER_SIZE>
+const uint8_t __TWI__<REGISTERS, BUFFER_SIZE>::setPolling(const uint8_t enabled)
+{
+    if (this->state != TWI_READY || this->inRepStart)  /**< Don't switch in the middle of a transaction. */
+        return (0);
+
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)  /**< Keep the ISR away while TWIE changes. */
     {
-        /* ALL MASTER */
-        case TW_START:  /**< Start condition detected */
-        case TW_REP_START:  /**< Repeated start condition detected */
-            *this->twdr = this->address;  /**< Write the TWI address into the data register. */
-            *this->twcr = TWI_SEND_ACK;  /**< Send ACK to the master. */
-            break;
-        
-        /* MASTER TRANSMITTER */
-        case TW_MT_SLA_ACK:  /**< Addressed, returned ACK */
-        case TW_MT_DATA_ACK:  /**< Data sent, returned ACK */
-            if (this->bufferIndex < this->bufferSize)  /**< If there is more data to transmit */
+        this->controlMask = enabled ? (const uint8_t)~(1 << TWIE) : (const uint8_t)0xFF;  /**< Mask TWIE out of every control word. */
+        if (this->began)  /**< Update the interrupt enable of the running peripheral. */
+            REGISTERS::twcr() = (REGISTERS::twcr() & ~((1 << TWINT) | (1 << TWSTA) | (1 << TWSTO) | (1 << TWIE))) | (enabled ? 0 : (1 << TWIE));
+    }
+
+    return (1);  /**< Return 1 to indicate the mode was switched. */
+}
+
+
+/**
+ * @brief Lets the blocking calls sleep while a transaction is in flight.
+ * 
+ * Instead of spinning, a blocking call enters idle sleep and the TWI interrupt wakes the 
+ * CPU for every bus event, so the CPU only draws current while the ISR runs. Any other 
+ * interrupt wakes it as well. Timeouts can't count microseconds while asleep: every wake-up 
+ * without bus progress counts as `TWI_SLEEP_TICK` microseconds (1024 by default, the Timer0 
+ * overflow of the Arduino core), so a periodic interrupt must be running for timeouts to 
+ * expire. Polling mode never sleeps. The default is off, or on if `TWI_SLEEP` is defined.
+ * 
+ * @param enabled `1` to sleep while waiting, `0` to spin.
+ */
+template <class REGISTERS, uint16_t BUFFER_SIZE>
+void __TWI__<REGISTERS, BUFFER_SIZE>::setSleep(const uint8_t enabled)
+{
+    this->sleeping = enabled;  /**< Picked up by the next wait. */
+}
+
+
+/**
+ * @brief Enters power-down until the slave is addressed.
+ * 
+ * With the peripheral idle in slave mode, the TWI address match is one of the few 
+ * sources that wake the MCU from power-down. The hardware holds SCL low during the 
+ * oscillator start-up time set by the fuses and until the ISR has handled the address, 
+ * so the master is stretched rather than refused. Other enabled interrupts (external 
+ * pins, watchdog) wake the MCU too; call again if the slave was not addressed.
+ * 
+ * @return `1` if the slave was addressed, `0` if another interrupt woke the MCU or the 
+ *         peripheral is not an idle, interrupt driven slave.
+ */
+template <class REGISTERS, uint16_t BUFFER_SIZE>
+const uint8_t __TWI__<REGISTERS, BUFFER_SIZE>::powerDown(void)
+{
+    if (this->role != TWI_ROLE_SLAVE || this->state != TWI_READY || !(this->controlMask & (1 << TWIE)))  /**< Only an idle slave is woken by its address. */
+        return (0);
+
+    const uint8_t seen = this->activity;  /**< The ISR activity before sleeping. */
+
+    set_sleep_mode(SLEEP_MODE_PWR_DOWN);
+    cli();  /**< Check and sleep without an interrupt slipping in between... */
+    if (seen == this->activity)
+    {
+        sleep_enable();
+        sei();        /**< ...the instruction after SEI runs before any interrupt... */
+        sleep_cpu();  /**< ...so one pending by now wakes the CPU right away. */
+        sleep_disable();
+    }
+    sei();
+
+    return (seen != this->activity);  /**< The ISR ran, the slave was addressed. */
+}
+
+
+/**
+ * @brief Returns the TWI status of the last buffered master transaction.
+ * 
+ * After a non-blocking transaction has finished, this is the same value that 
+ * `endTransmission()` would have returned (e.g. `TW_MT_DATA_ACK`, `TW_MT_SLA_NACK`).
+ * 
+ * @return The final TWI status code of the transaction.
+ */
+template <class REGISTERS, uint16_t BUFFER_SIZE>
+const uint8_t __TWI__<REGISTERS, BUFFER_SIZE>::getStatus(void)
+{
+    return (this->transfer.status);  /**< Return the final status of the buffered transfer. */
+}
+
+
+/**
+ * @brief Queues a master transaction to be run by the ISR.
+ * 
+ * This function appends a caller-owned transaction to the fixed-capacity queue of this 
+ * instance. If the bus is idle, or held by a previous transaction that ended with a 
+ * repeated START, the transaction is started right away, otherwise `isr()` 
+ * issues its START as soon as the transaction in front of it has finished, keeping the 
+ * bus busy during back-to-back transfers. Every queued transaction ends with a STOP.
+ * 
+ * The transaction and its buffers must stay valid until its `done` flag is set; its 
+ * `status` and `count` fields then report the outcome.
+ * 
+ * @param transaction Pointer to the transaction to run.
+ * 
+ * @return `1` if the transaction was queued, `0` if the role is not master or the 
+ *         queue is full.
+ */
+template <class REGISTERS, uint16_t BUFFER_SIZE>
+const uint8_t __TWI__<REGISTERS, BUFFER_SIZE>::enqueue(TWI_Transaction* transaction)
+{
+    if (this->role != TWI_ROLE_MASTER)  /**< Check if the role is MASTER, return 0 if not. */
+        return (0);
+
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)  /**< The ISR consumes the queue, keep it consistent. */
+    {
+        if (this->queueCount >= TWI_QUEUE_SIZE)  /**< Check if there is room left in the queue. */
+            return (0);  /**< Return 0 if the queue is full. */
+
+        transaction->done = 0;  /**< The transaction is now pending. */
+
+        if (this->state == TWI_READY)  /**< If the bus is idle, or held by a repeated START... */
+        {
+            this->load(transaction, 1);  /**< ...prepare the transaction... */
+            this->launch();  /**< ...and put it on the bus right away. */
+        }
+        else
+        {
+            uint8_t tail = this->queueHead + this->queueCount;  /**< Find the free slot behind the last entry. */
+            if (tail >= TWI_QUEUE_SIZE)  /**< Wrap around the end of the ring. */
+                tail -= TWI_QUEUE_SIZE;
+            this->queue[tail] = transaction;  /**< Store the transaction. */
+            this->queueCount++;  /**< Account for the new entry. */
+        }
+    }
+
+    return (1);  /**< Return 1 to indicate the transaction was accepted. */
+}
+
+
+/**
+ * @brief Returns the number of transactions waiting in the queue.
+ * 
+ * The transaction currently on the bus is not counted.
+ * 
+ * @return The number of queued transactions.
+ */
+template <class REGISTERS, uint16_t BUFFER_SIZE>
+const uint8_t __TWI__<REGISTERS, BUFFER_SIZE>::queued(void)
+{
+    return (this->queueCount);  /**< Return the number of waiting transactions. */
+}
+
+
+/**
+ * @brief Advances a task without blocking.
+ * 
+ * A ready task is submitted to the queue; while the queue is full it stays ready and is 
+ * submitted on a later call, so tasks get the bus in the order they asked for it. A 
+ * pending task is checked for completion (and driven in polling mode). Once finished, the 
+ * task is done if `result()` judges its status `TWI_RESULT_OK`, or in error otherwise; the 
+ * state stays there until the application sets it back to `TWI_TASK_READY`.
+ * 
+ * Call this from the main loop for every task; several tasks can be in flight at once, 
+ * up to `TWI_QUEUE_SIZE`.
+ * 
+ * @param task Pointer to the task to advance.
+ * 
+ * @return The state of the task, `TWI_TASK_PENDING` as long as it has not finished.
+ */
+template <class REGISTERS, uint16_t BUFFER_SIZE>
+const uint8_t __TWI__<REGISTERS, BUFFER_SIZE>::poll(TWI_Task* task)
+{
+    this->poll();  /**< In polling mode, move the bus along. */
+
+    switch (task->state)  /**< Advance the task from where it stands. */
+    {
+        case TWI_TASK_READY:  /**< Not submitted yet */
+            if (this->role != TWI_ROLE_MASTER)  /**< Only a master can run it. */
+                return (task->state = TWI_TASK_ERROR);
+            if (this->enqueue(&task->transaction))  /**< Submit it unless the queue is full. */
+                task->state = TWI_TASK_PENDING;
+            return (TWI_TASK_PENDING);  /**< Either way, it has not finished. */
+
+        case TWI_TASK_PENDING:  /**< On the bus or waiting in the queue */
+            if (!task->transaction.done)  /**< Still running. */
+                return (TWI_TASK_PENDING);
+            if (this->result(task->transaction.status) == TWI_RESULT_OK)  /**< Judge the outcome. */
+                return (task->state = TWI_TASK_DONE);
+            return (task->state = TWI_TASK_ERROR);  /**< NACK, arbitration lost, bus error or timeout. */
+    }
+
+    return (task->state);  /**< Finished, report the outcome again. */
+}
+
+
+#ifndef TWI_LEAN
+/**
+ * @brief Sets up the autonomous scan of device registers.
+ * 
+ * Every pass started with `scan()` reads all entries, one write-then-read transaction 
+ * each, chained by the ISR without any foreground work. The bytes go into the back 
+ * snapshot; at the end of the pass it is published and `takeScan()` swaps it with the 
+ * front snapshot the application reads. Both buffers must hold every entry's `offset + 
+ * length`. Entries run ahead of queued transactions while a pass is in flight.
+ * 
+ * @param entries Pointer to the scan list, must stay valid while scans run.
+ * @param count The number of entries, `0` disables the scan.
+ * @param front Pointer to the first snapshot buffer.
+ * @param back Pointer to the second snapshot buffer.
+ * 
+ * @return `1` if the scan was set up, `0` if a pass is still running.
+ */
+template <class REGISTERS, uint16_t BUFFER_SIZE>
+const uint8_t __TWI__<REGISTERS, BUFFER_SIZE>::setScan(const TWI_ScanEntry* entries, const uint8_t count, uint8_t* front, uint8_t* back)
+{
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)  /**< The ISR walks the list, keep it consistent. */
+    {
+        if (this->scanIndex < this->scanCount)  /**< Don't pull the list from under a running pass. */
+            return (0);
+
+        this->scanList = entries;   /**< Store the list... */
+        this->scanCount = count;
+        this->scanIndex = count;    /**< ...with no pass running... */
+        this->scanReady = 0;        /**< ...and nothing published. */
+        this->scanFront = front;    /**< Store the snapshots. */
+        this->scanBack = back;
+    }
+
+    return (1);  /**< Return 1 to indicate the scan was set up. */
+}
+
+
+/**
+ * @brief Starts a pass over the scan list.
+ * 
+ * Meant to be called periodically, from a timer interrupt or the main loop. If the bus 
+ * is busy, the pass starts as soon as the current transaction has finished. A published 
+ * snapshot that was not taken yet is dropped, its buffer is filled again.
+ * 
+ * @return `1` if the pass was started, `0` if the previous pass is still running, no 
+ *         scan is set up or the role is not master.
+ */
+template <class REGISTERS, uint16_t BUFFER_SIZE>
+const uint8_t __TWI__<REGISTERS, BUFFER_SIZE>::scan(void)
+{
+    if (this->role != TWI_ROLE_MASTER)  /**< Check if the role is MASTER, return 0 if not. */
+        return (0);
+
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)  /**< The ISR walks the list, keep it consistent. */
+    {
+        if (!this->scanCount || this->scanIndex < this->scanCount)  /**< Nothing to scan, or the last pass overran. */
+            return (0);
+
+        this->scanIndex = 0;   /**< Start with the first entry. */
+        this->scanFailed = 0;  /**< Nothing failed yet. */
+        this->scanReady = 0;   /**< The back snapshot is being overwritten. */
+
+        if (this->state == TWI_READY)  /**< If the bus is idle, or held by a repeated START... */
+        {
+            this->load(this->scanEntry(), 1);  /**< ...prepare the first entry... */
+            this->launch();  /**< ...and put it on the bus right away. */
+        }
+    }
+
+    return (1);  /**< Return 1 to indicate the pass was started. */
+}
+
+
+/**
+ * @brief Takes the snapshot of the last finished pass.
+ * 
+ * The front and back snapshots are swapped atomically, the returned buffer stays 
+ * untouched by the ISR until the next successful call.
+ * 
+ * @param failed Receives the number of entries that failed in the pass, may be `NULL`.
+ * 
+ * @return Pointer to the fresh snapshot, `NULL` if no pass has finished since the last call.
+ */
+template <class REGISTERS, uint16_t BUFFER_SIZE>
+const uint8_t* __TWI__<REGISTERS, BUFFER_SIZE>::takeScan(uint8_t* failed)
+{
+    uint8_t* snapshot = NULL;  /**< Nothing new by default. */
+
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)  /**< Swap against a pass starting in an interrupt. */
+    {
+        if (this->scanReady)  /**< A pass has finished. */
+        {
+            snapshot = this->scanBack;         /**< The finished snapshot... */
+            this->scanBack = this->scanFront;  /**< ...trades places with the one the application had. */
+            this->scanFront = snapshot;
+            this->scanReady = 0;               /**< Taken. */
+            if (failed != NULL)                /**< Report the failures of the pass. */
+                *failed = this->scanFailed;
+        }
+    }
+
+    return (snapshot);  /**< Return the fresh snapshot. */
+}
+#endif
+
+
+/**
+ * @brief Sets the timeout of the blocking calls.
+ * 
+ * Every blocking call (`beginTransmission()`, `endTransmission()`, `requestFrom()`, 
+ * `transmit()`, `writeThenRead()`, ...) gives up once the bus made no progress for this 
+ * long: the transaction is aborted with `TWI_ERROR_TIMEOUT` and the bus is recovered (see 
+ * `recover()`). Progress is any TWI interrupt, so long transfers are never cut short. The 
+ * default is `TWI_DEFAULT_TIMEOUT`; `0` waits forever.
+ * 
+ * @param microseconds The maximum time without bus progress.
+ */
+template <class REGISTERS, uint16_t BUFFER_SIZE>
+void __TWI__<REGISTERS, BUFFER_SIZE>::setTimeout(const uint16_t microseconds)
+{
+    this->timeout = microseconds;  /**< Store the timeout. */
+}
+
+
+/**
+ * @brief Returns the timeout of the blocking calls.
+ * 
+ * Layers built on `wait()` use it so their blocking calls honour `setTimeout()` as well.
+ * 
+ * @return The maximum time without bus progress in microseconds, `0` if waiting forever.
+ */
+template <class REGISTERS, uint16_t BUFFER_SIZE>
+const uint16_t __TWI__<REGISTERS, BUFFER_SIZE>::getTimeout(void)
+{
+    return (this->timeout);  /**< Return the timeout. */
+}
+
+
+/**
+ * @brief Waits for a transaction to finish, bounded by its own timeout.
+ * 
+ * This function lets every queued or non-blocking transaction be waited for with a 
+ * timeout of its own. If the bus makes no progress for `timeout` microseconds, the 
+ * transaction on the bus is aborted with `TWI_ERROR_TIMEOUT` and the bus is recovered; 
+ * if the transaction was still queued, it is removed from the queue and finished with 
+ * `TWI_ERROR_TIMEOUT` as well, so it can be reused once the call returns. If the STOP 
+ * ending the transaction doesn't complete within `TWI_STOP_TIMEOUT`, it reports 
+ * `TWI_ERROR_BUS_STUCK` and the bus is recovered.
+ * 
+ * @param transaction Pointer to the transaction to wait for.
+ * @param timeout The maximum time without bus progress in microseconds, `0` waits forever.
+ * 
+ * @return The final status of the transaction.
+ */
+template <class REGISTERS, uint16_t BUFFER_SIZE>
+const uint8_t __TWI__<REGISTERS, BUFFER_SIZE>::wait(TWI_Transaction* transaction, const uint16_t timeout)
+{
+    uint16_t remaining = timeout;  /**< Time left without bus progress. */
+    uint8_t seen = this->activity;  /**< The last observed ISR activity. */
+
+    while (!transaction->done)  /**< Wait for the ISR to hand the transaction back. */
+    {
+        if (this->expired(&remaining, &seen, timeout))  /**< The bus made no progress in time. */
+        {
+            uint8_t queued;
+            ATOMIC_BLOCK(ATOMIC_RESTORESTATE)  /**< Queued behind the hung one, take it out... */
             {
-                *this->twdr = this->buffer[this->bufferIndex++];  /**< Write the data byte into TWDR. */
-                *this->twcr = TWI_SEND_ACK;  /**< Send ACK. */
+                queued = this->dequeue(transaction);
             }
-            else  /**< No more data to send */
+            if (queued)  /**< ...and finish it, nothing refers to it anymore. */
             {
-                if (this->sendStop)  /**< If a stop condition should be sent */
-                    this->stop();  /**< Send a stop condition. */
-                else  /**< If the transmission should continue */
-                {
-                    this->inRepStart = 1;  /**< Mark that we are in repeated start. */
-                    *this->twcr = TWI_SEND_REP_START;  /**< Send a repeated start condition. */
-                    this->state = TWI_READY;  /**< Set state to ready for more transactions. */
-                }
+                transaction->status = TWI_ERROR_TIMEOUT;
+                transaction->done = 1;
             }
+            this->recoverBus(TWI_ERROR_TIMEOUT);  /**< Abort whatever hangs and clear the bus. */
             break;
-        
-        case TW_MT_SLA_NACK:  /**< Addressed, returned NACK */
-        case TW_MT_DATA_NACK:  /**< Data sent, returned NACK */
-            this->stop();  /**< Send a stop condition. */
-            break;
+        }
+    }
+
+    if (transaction->done && transaction->status != TWI_ERROR_TIMEOUT && !this->stopped())  /**< The STOP never made it onto the bus. */
+    {
+        transaction->status = TWI_ERROR_BUS_STUCK;  /**< Report the stuck bus... */
+        this->recoverBus(TWI_ERROR_BUS_STUCK);      /**< ...and clear it before the next transaction. */
+    }
+
+    return (transaction->done ? transaction->status : TWI_ERROR_TIMEOUT);  /**< Return the final status. */
+}
+
+
+/**
+ * @brief Recovers a stuck bus and re-initializes the TWI peripheral.
+ * 
+ * A transaction in flight is aborted with `TWI_ERROR_ABORTED`. While a slave holds SDA 
+ * low, SCL is pulsed up to nine times, then a STOP condition is generated and the TWI 
+ * control register is re-initialized. The blocking calls do this on their own when they 
+ * time out; the function is meant for applications using the non-blocking API or the 
+ * queue that detect a hang themselves, or that see `TW_BUS_ERROR`.
+ * 
+ * @return `1` if the bus is free again, `0` if a device still holds a line low.
+ */
+template <class REGISTERS, uint16_t BUFFER_SIZE>
+const uint8_t __TWI__<REGISTERS, BUFFER_SIZE>::recover(void)
+{
+    return (this->recoverBus(TWI_ERROR_ABORTED));  /**< Abort with an explicit status. */
+}
+
+
+/**
+ * @brief Counts down the backoff of a transaction waiting for its retry.
+ * 
+ * Once the backoff has passed, the transaction is started again. The blocking calls 
+ * count on their own while they wait; applications using the non-blocking API or the 
+ * queue with backoffs call it periodically, e.g. `TWI0.tick(1000)` from a millisecond 
+ * timer interrupt. Without a backoff pending it does nothing.
+ * 
+ * @param microseconds The time passed since the last call.
+ */
+template <class REGISTERS, uint16_t BUFFER_SIZE>
+void __TWI__<REGISTERS, BUFFER_SIZE>::tick(const uint16_t microseconds)
+{
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)  /**< The ISR sets the backoff, keep it consistent. */
+    {
+        if (this->backoff > microseconds)  /**< Still backing off. */
+            this->backoff -= microseconds;
+        else if (this->backoff)  /**< The backoff has passed... */
+        {
+            this->backoff = 0;
+            this->launch();  /**< ...issue the START of the retry. */
+        }
+    }
+}
+
+
+/**
+ * @brief Classifies the final status of a master transaction.
+ * 
+ * The status codes tell exactly what happened on the bus, but differ by direction; the 
+ * result tells what to do about it: `TWI_RESULT_ADDRESS_NACK` means no device answered 
+ * (absent or busy), `TWI_RESULT_DATA_NACK` that the device refused a written byte.
+ * 
+ * @param status The final status, as returned by the blocking calls or reported in 
+ *               `TWI_Transaction::status`.
+ * 
+ * @return `TWI_RESULT_OK`, `TWI_RESULT_ADDRESS_NACK`, `TWI_RESULT_DATA_NACK`, 
+ *         `TWI_RESULT_ARBITRATION_LOST` or `TWI_RESULT_ERROR` (timeout, bus error, PEC).
+ */
+template <class REGISTERS, uint16_t BUFFER_SIZE>
+const uint8_t __TWI__<REGISTERS, BUFFER_SIZE>::result(const uint8_t status)
+{
+    switch (status)
+    {
+        case TW_MT_SLA_ACK:    /**< An address probe. */
+        case TW_MT_DATA_ACK:   /**< Every byte written. */
+        case TW_MR_DATA_NACK:  /**< Every byte read. */
+            return (TWI_RESULT_OK);
+        case TW_MT_SLA_NACK:
+        case TW_MR_SLA_NACK:
+            return (TWI_RESULT_ADDRESS_NACK);
+        case TW_MT_DATA_NACK:
+            return (TWI_RESULT_DATA_NACK);
+        case TW_MT_ARB_LOST:
+            return (TWI_RESULT_ARBITRATION_LOST);
+        default:
+            return (TWI_RESULT_ERROR);
+    }
+}
+
+
+/**
+ * @brief Returns the number of bytes available in the receive buffer.
+ * 
+ * This function calculates the number of bytes that have been successfully received
+ * from the slave device and stored in the buffer, but not yet read by the user. It 
+ * subtracts the current index from the total buffer size to provide the number of 
+ * remaining bytes available for reading.
+ * 
+ * @return The number of bytes available in the buffer for reading.
+ */
+template <class REGISTERS, uint16_t BUFFER_SIZE>
+const typename __TWI__<REGISTERS, BUFFER_SIZE>::length_t __TWI__<REGISTERS, BUFFER_SIZE>::available(void)
+{
+    return (this->bufferSize - this->bufferIndex);  /**< Calculate available bytes by subtracting the current index from the buffer size. */
+}
+
+
+/**
+ * @brief Reads a byte of data from the receive buffer.
+ * 
+ * This function reads the next byte from the buffer, incrementing the buffer index.
+ * If there are no more bytes available to read (i.e., the index exceeds the buffer size),
+ * it returns 0.
+ * 
+ * @return The next byte of data from the buffer, or `0` if there are no more bytes to read.
+ */
+template <class REGISTERS, uint16_t BUFFER_SIZE>
+const uint8_t __TWI__<REGISTERS, BUFFER_SIZE>::read(void)
+{
+    if (this->bufferIndex >= this->bufferSize)  /**< Check if all data has been read from the buffer. */
+        return (0);  /**< If no data is left, return 0. */
+    return (this->buffer[this->bufferIndex++]);  /**< Return the next byte and increment the buffer index. */
+}
+
+
+/**
+ * @brief Ends the current TWI (I2C) communication.
+ * 
+ * This function stops any ongoing communication and resets the TWI interface to 
+ * its initial state. It also restores the default role (master) and clears the address.
+ * 
+ * @return `1` if the operation was successful, `0` if the TWI interface was not 
+ *         initialized previously.
+ */
+template <class REGISTERS, uint16_t BUFFER_SIZE>
+const uint8_t __TWI__<REGISTERS, BUFFER_SIZE>::end(void)
+{
+    if (!this->began)  /**< Check if the TWI interface was initialized. */
+        return (0);  /**< Return 0 if not initialized. */
+    
+    this->began = 0;  /**< Mark the TWI interface as uninitialized. */
+
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)  /**< Ensure atomic operation to prevent interruption during TWI operations. */
+    {
+        REGISTERS::twcr() = TWI_END;  /**< Disable TWI communication. */
+        REGISTERS::twar() = 0;  /**< Clear the TWI address register. */
+        REGISTERS::twamr() = 0;  /**< Clear the TWI address mask register. */
+        this->control(TWI_BEGIN);  /**< Re-enable TWI communication. */
+        REGISTERS::twbr() = 0;  /**< Clear the TWI bit rate register. */
+        this->role = TWI_ROLE_MASTER;  /**< Set the role back to master. */
+        this->address = REGISTERS::twar();  /**< Store the address from the TWI address register. */
+    }
+        
+    return (1);  /**< Return 1 to indicate successful completion. */
+}
+
+
+/**
+ * @brief Sets the callback function for receiving data with a specified size.
+ * 
+ * This function assigns a user-defined callback to be executed when data is received 
+ * via TWI. The callback function should take a single `uint8_t` parameter, which 
+ * represents the size of the received data.
+ * 
+ * @param function The callback function to be executed when data is received. It 
+ *                 should have the signature `void function(length_t size)` where 
+ *                 `size` indicates the size of the received data.
+ */
+template <class REGISTERS, uint16_t BUFFER_SIZE>
+void __TWI__<REGISTERS, BUFFER_SIZE>::setRxCallback(void (*function)(const length_t size))
+{
+    this->rxCallback = function;  /**< Store the provided function in the rxCallback member. */
+}
+
+/**
+ * @brief Sets the callback function for transmitting data.
+ * 
+ * This function assigns a user-defined callback to be executed when the TWI is ready 
+ * to transmit data. The callback function does not take any parameters.
+ * 
+ * @param function The callback function to be executed when TWI is ready to transmit. 
+ *                 It should have the signature `void function()`.
+ */
+template <class REGISTERS, uint16_t BUFFER_SIZE>
+void __TWI__<REGISTERS, BUFFER_SIZE>::setTxCallback(void (*function)(void))
+{
+    this->txCallback = function;  /**< Store the provided function in the txCallback member. */
+}
+
+
+/**
+ * @brief Sets the function producing the bytes transmitted in slave mode.
+ * 
+ * With a producer set, the ISR pulls every byte the master reads from it, one call per 
+ * byte, instead of calling the TX callback once and sending the buffer. Replies can be 
+ * of any length and stream from a source like a ring buffer of samples; the master ends 
+ * the read with a NACK whenever it has enough. The producer runs in interrupt context 
+ * and should return quickly; `getMatchedAddress()` tells which address is read. A 
+ * register map takes precedence over the producer.
+ * 
+ * @param function The producer, `NULL` to go back to the TX callback and buffer. It 
+ *                 should have the signature `uint8_t function()`.
+ */
+template <class REGISTERS, uint16_t BUFFER_SIZE>
+void __TWI__<REGISTERS, BUFFER_SIZE>::setTxProducer(uint8_t (*function)(void))
+{
+    this->txProducer = function;  /**< Store the provided function in the txProducer member. */
+}
+
+
+/**
+ * @brief Enables SMBus Packet Error Checking in slave mode.
+ * 
+ * The ISR runs every byte of a message through the PEC, the address bytes included. A 
+ * frame received from the master is valid if it ends with the right PEC, see `checkPec()`; 
+ * the PEC byte is handed to the application as the last byte of the frame. A reply sent 
+ * from the buffer is followed by its PEC, computed over the command written before the 
+ * repeated START and the reply itself. Replies from a register map or TX producer carry 
+ * no PEC.
+ * 
+ * @param enabled `1` to use PEC, `0` for plain I2C.
+ */
+template <class REGISTERS, uint16_t BUFFER_SIZE>
+void __TWI__<REGISTERS, BUFFER_SIZE>::setPec(const uint8_t enabled)
+{
+    this->pec = enabled ? 1 : 0;  /**< Picked up by the next message. */
+}
+
+
+/**
+ * @brief Checks the PEC of the last frame received in slave mode.
+ * 
+ * Meant for the RX callback or frame handler. A frame that only carries the command of 
+ * a following read has no PEC and does not pass.
+ * 
+ * @return `1` if the frame ended with a valid PEC, `0` otherwise or if PEC is disabled.
+ */
+template <class REGISTERS, uint16_t BUFFER_SIZE>
+const uint8_t __TWI__<REGISTERS, BUFFER_SIZE>::checkPec(void)
+{
+    return (this->pecValid);  /**< Return the result of the last frame. */
+}
+
+
+/**
+ * @brief Sets the callback function for finished master transactions.
+ * 
+ * This function assigns a user-defined callback to be executed by the ISR when a 
+ * transaction started with `startTransmission()` or `startRequest()` (or one of their 
+ * blocking wrappers) has finished. The callback runs in interrupt context and may start 
+ * the next transaction right away.
+ * 
+ * @param function The callback function to be executed on completion. It should have 
+ *                 the signature `void function(uint8_t status)` where `status` is the 
+ *                 final TWI status of the transaction.
+ */
+template <class REGISTERS, uint16_t BUFFER_SIZE>
+void __TWI__<REGISTERS, BUFFER_SIZE>::setDoneCallback(void (*function)(const uint8_t status))
+{
+    this->doneCallback = function;  /**< Store the provided function in the doneCallback member. */
+}
+
+
+#ifndef TWI_LEAN
+/**
+ * @brief Registers a ring of frames for slave reception.
+ * 
+ * Once a ring is registered, `isr()` stores every write from a master in its own frame 
+ * instead of the internal buffer, and the RX callback is no longer called from interrupt 
+ * context. The application drains the frames later with `peekFrame()`/`releaseFrame()` or 
+ * `dispatch()`, so bursts of writes are ACKed without waiting for the application. When 
+ * all frames are full, further data is NACKed rather than overwriting unread frames.
+ * 
+ * The ring is a lock-free single-producer (ISR) / single-consumer (application) queue; 
+ * one frame is always kept free, so `count` frames hold up to `count - 1` messages.
+ * 
+ * @param frames Pointer to the caller-owned frames, or `NULL` to return to the internal buffer.
+ * @param count The number of frames, at least `2`.
+ * 
+ * @return `1` if the ring was registered, `0` if `count` is too small.
+ */
+template <class REGISTERS, uint16_t BUFFER_SIZE>
+const uint8_t __TWI__<REGISTERS, BUFFER_SIZE>::setRxRing(TWI_Frame* frames, const uint8_t count)
+{
+    if (frames != NULL && count < 2)  /**< Check if the ring can hold at least one message. */
+        return (0);
+
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)  /**< The ISR fills the ring, keep it consistent. */
+    {
+        this->ring = frames;  /**< Store the frames. */
+        this->ringSize = count;  /**< Store their number. */
+        this->ringHead = 0;  /**< Start with an empty ring. */
+        this->ringTail = 0;
+        this->frame = NULL;  /**< No frame is being filled. */
+    }
+
+    return (1);  /**< Return 1 to indicate the ring was registered. */
+}
+
+
+/**
+ * @brief Returns the number of received frames waiting in the ring.
+ * 
+ * @return The number of frames not yet drained.
+ */
+template <class REGISTERS, uint16_t BUFFER_SIZE>
+const uint8_t __TWI__<REGISTERS, BUFFER_SIZE>::frames(void)
+{
+    const uint8_t head = this->ringHead;  /**< Sample the producer index once. */
+    return ((head >= this->ringTail) ? (head - this->ringTail) : (head + this->ringSize - this->ringTail));  /**< Distance from tail to head. */
+}
+
+
+/**
+ * @brief Returns the oldest received frame without removing it from the ring.
+ * 
+ * The frame stays valid and untouched by the ISR until `releaseFrame()` is called.
+ * 
+ * @return Pointer to the oldest frame, or `NULL` if the ring is empty.
+ */
+template <class REGISTERS, uint16_t BUFFER_SIZE>
+const TWI_Frame* __TWI__<REGISTERS, BUFFER_SIZE>::peekFrame(void)
+{
+    if (this->ringTail == this->ringHead)  /**< Check if there is anything to drain. */
+        return (NULL);  /**< Return NULL if the ring is empty. */
+
+    return (&this->ring[this->ringTail]);  /**< Return the oldest frame. */
+}
+
+
+/**
+ * @brief Removes the oldest received frame from the ring, making room for the ISR.
+ */
+template <class REGISTERS, uint16_t BUFFER_SIZE>
+void __TWI__<REGISTERS, BUFFER_SIZE>::releaseFrame(void)
+{
+    if (this->ringTail == this->ringHead)  /**< Nothing to release in an empty ring. */
+        return;
+
+    uint8_t next = this->ringTail + 1;  /**< Advance the tail... */
+    if (next >= this->ringSize)  /**< ...around the end of the ring. */
+        next = 0;
+    this->ringTail = next;  /**< Hand the frame back to the ISR. */
+}
+
+
+/**
+ * @brief Dispatches every received frame to the frame callback from the main loop.
+ * 
+ * This function is meant to be called from the main loop. It passes each waiting frame 
+ * to the callback set with `setFrameCallback()` in arrival order and releases it 
+ * afterwards, so the callback never runs in interrupt context.
+ * 
+ * @return The number of frames dispatched.
+ */
+template <class REGISTERS, uint16_t BUFFER_SIZE>
+const uint8_t __TWI__<REGISTERS, BUFFER_SIZE>::dispatch(void)
+{
+    uint8_t dispatched = 0;  /**< Count the handled frames. */
+    const TWI_Frame* frame;
+
+    while ((frame = this->peekFrame()) != NULL)  /**< Handle frames until the ring is empty. */
+    {
+        if (this->frameCallback != NULL)  /**< If a frame callback is set */
+            this->frameCallback(frame->data, frame->length);  /**< Call it with the frame contents. */
+        this->releaseFrame();  /**< Make room for the ISR. */
+        dispatched++;
+    }
+
+    return (dispatched);  /**< Return the number of handled frames. */
+}
+
+
+/**
+ * @brief Sets the callback function for frames dispatched from the main loop.
+ * 
+ * @param function The callback function called by `dispatch()`. It should have the 
+ *                 signature `void function(const uint8_t* data, uint8_t length)`.
+ */
+template <class REGISTERS, uint16_t BUFFER_SIZE>
+void __TWI__<REGISTERS, BUFFER_SIZE>::setFrameCallback(void (*function)(const uint8_t* data, const uint8_t length))
+{
+    this->frameCallback = function;  /**< Store the provided function in the frameCallback member. */
+}
+#endif
+
+
+/**
+ * @brief Serves a memory region as an EEPROM-style register map in slave mode.
+ * 
+ * Once a map is registered, `isr()` answers the master without any callback: the first 
+ * byte of every write sets the register pointer, further written bytes are stored at the 
+ * pointer and reads return the registers starting at the pointer. The pointer 
+ * auto-increments and wraps around the end of the map, so transfers may be longer than 
+ * the internal buffer. The map takes precedence over the receive ring and the TX callback.
+ * 
+ * The masks hold one bit per register (bit `n & 7` of byte `n >> 3`). Writes to read-only 
+ * registers are ignored, write-only registers read as `0xFF`.
+ * 
+ * @param registers Pointer to the memory region, or `NULL` to stop serving a map.
+ * @param size The number of registers, at most `256`.
+ * @param readOnly Bit mask of read-only registers, or `NULL` if all are writable.
+ * @param writeOnly Bit mask of write-only registers, or `NULL` if all are readable.
+ * 
+ * @return `1` if the map was registered, `0` if `size` is out of range.
+ */
+template <class REGISTERS, uint16_t BUFFER_SIZE>
+const uint8_t __TWI__<REGISTERS, BUFFER_SIZE>::setRegisterMap(volatile uint8_t* registers, const uint16_t size, const uint8_t* readOnly, const uint8_t* writeOnly)
+{
+    if (registers != NULL && (!size || size > 256))  /**< The pointer is a single byte. */
+        return (0);
+
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)  /**< The ISR serves the map, keep it consistent. */
+    {
+        this->registerMap = registers;  /**< Store the region. */
+        this->registerCount = size;  /**< Store its size. */
+        this->readOnlyMask = readOnly;  /**< Store the read-only mask. */
+        this->writeOnlyMask = writeOnly;  /**< Store the write-only mask. */
+        this->registerPointer = 0;  /**< Start at the first register. */
+        this->registerPending = 0;
+    }
+
+    return (1);  /**< Return 1 to indicate the map was registered. */
+}
+
+
+/**
+ * @brief Serves a memory region as a fully readable and writable register map.
+ * 
+ * This function calls the full `setRegisterMap` without access masks.
+ * 
+ * @param registers Pointer to the memory region, or `NULL` to stop serving a map.
+ * @param size The number of registers, at most `256`.
+ * 
+ * @return `1` if the map was registered, `0` if `size` is out of range.
+ */
+template <class REGISTERS, uint16_t BUFFER_SIZE>
+const uint8_t __TWI__<REGISTERS, BUFFER_SIZE>::setRegisterMap(volatile uint8_t* registers, const uint16_t size)
+{
+    return (this->setRegisterMap(registers, size, NULL, NULL));  /**< Call the full setRegisterMap without masks. */
+}
+
+
+/**
+ * @brief Registers a table of virtual slave devices.
+ * 
+ * Together with an address mask (see `begin(address, mask)`), this lets one TWI peripheral 
+ * emulate several devices. When the master addresses the slave, the ISR looks up the 
+ * matched address in the table and calls that entry's RX/TX callbacks instead of the 
+ * ones set with `setRxCallback()`/`setTxCallback()`. Addresses without an entry keep 
+ * using those callbacks. The table must stay valid while it is registered.
+ * 
+ * @param handlers Pointer to the table, or `NULL` to remove it.
+ * @param count The number of entries in the table.
+ */
+template <class REGISTERS, uint16_t BUFFER_SIZE>
+void __TWI__<REGISTERS, BUFFER_SIZE>::setSlaveHandlers(const SlaveHandler* handlers, const uint8_t count)
+{
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)  /**< The ISR reads the table, keep it consistent. */
+    {
+        this->handlers = handlers;  /**< Store the table. */
+        this->handlerCount = (handlers != NULL) ? count : 0;  /**< Store its size. */
+        this->handler = NULL;  /**< Forget the last selected entry. */
+    }
+}
+
+
+/**
+ * @brief Returns the address the master used for the last slave access.
+ * 
+ * Callbacks can use it to tell the answered addresses apart. A general call reads as `0`.
+ * 
+ * @return The 7-bit matched address.
+ */
+template <class REGISTERS, uint16_t BUFFER_SIZE>
+const uint8_t __TWI__<REGISTERS, BUFFER_SIZE>::getMatchedAddress(void)
+{
+    return (this->matched);  /**< Return the latched address. */
+}
+
+
+/**
+ * @brief Interrupt Service Routine (ISR) for handling TWI events.
+ * 
+ * This function is called when a TWI interrupt occurs, and it handles the 
+ * different TWI events, such as START, STOP, data reception, and transmission 
+ * for both master and slave modes. It manages the internal state of the TWI 
+ * interface and interacts with buffers and callback functions.
+ * 
+ * The status codes are multiples of 8, so `status >> 3` indexes the 32 entry 
+ * `transitions` table in flash directly: one `lpm` load and one indirect call 
+ * replace the compare chain of a `switch`, and every status costs the same to 
+ * dispatch. Each entry is the handler of one state transition, see `onStart()` 
+ * and the following functions.
+ * 
+ * @note While TWINT is set the hardware stretches SCL, so a slow ISR never loses a 
+ *       byte; it lowers the throughput instead. With `TWI_INSTRUMENTATION` the 
+ *       longest run is measured in `TWI_TRACE_TIMESTAMP()` ticks, overall (`isrTicks`) 
+ *       and per transition (`transitionTicks[status >> 3]`). With Timer1 running at 
+ *       F_CPU these are CPU cycles from the first timer read to the last one; the 
+ *       vector's register saves and restores and the interrupt latency come on top. 
+ *       The README lists the cycles of the default build and the measuring procedure.
+ */
+template <class REGISTERS, uint16_t BUFFER_SIZE>
+void __TWI__<REGISTERS, BUFFER_SIZE>::isr(void)
+{
+#ifdef TWI_INSTRUMENTATION
+    const uint16_t entry = TWI_TRACE_TIMESTAMP();  /**< Time the ISR run. */
+#endif
+    this->activity++;  /**< Signal bus progress to the timeouts of the waiting foreground. */
+    this->status = REGISTERS::twsr() & 0xF8;  /**< Read the status of TWI from TWSR register. */
+#ifdef TWI_INSTRUMENTATION
+    const uint8_t status = this->status;  /**< The handlers may overwrite it. */
+    this->record(this->status);  /**< Count and trace the status. */
+#endif
+
+    const Transition transition = (Transition)pgm_read_ptr(&transitions[this->status >> 3]);  /**< Look the handler of the status up. */
+    transition(this);  /**< Run it. */
+
+#ifdef TWI_INSTRUMENTATION
+    const uint16_t ticks = TWI_TRACE_TIMESTAMP() - entry;  /**< The duration of this run. */
+    if (ticks > this->stats.isrTicks)  /**< Keep the worst case... */
+        this->stats.isrTicks = ticks;
+    if (ticks > this->stats.transitionTicks[status >> 3])  /**< ...overall and of this transition. */
+        this->stats.transitionTicks[status >> 3] = ticks;
+#endif
+}
+
+
+/**
+ * @brief Calls a state transition handler of an instance.
+ * 
+ * One instantiation per handler, so the table holds plain function pointers (two 
+ * bytes in flash) and the handler is inlined into its trampoline.
+ * 
+ * @param twi The instance the ISR runs for.
+ */
+template <class REGISTERS, uint16_t BUFFER_SIZE>
+template <void (__TWI__<REGISTERS, BUFFER_SIZE>::*HANDLER)(void)>
+void __TWI__<REGISTERS, BUFFER_SIZE>::transition(__TWI__* twi)
+{
+    (twi->*HANDLER)();  //*< Run the handler on the instance.
+}
+
+
+/**
+ * @brief The state transition handlers indexed by `status >> 3`.
+ */
+template <class REGISTERS, uint16_t BUFFER_SIZE>
+const typename __TWI__<REGISTERS, BUFFER_SIZE>::Transition __TWI__<REGISTERS, BUFFER_SIZE>::transitions[32] PROGMEM =
+{
+    &__TWI__::template transition<&__TWI__::onBusError>,            /* 0x00 TW_BUS_ERROR */
+    &__TWI__::template transition<&__TWI__::onStart>,               /* 0x08 TW_START */
+    &__TWI__::template transition<&__TWI__::onStart>,               /* 0x10 TW_REP_START */
+    &__TWI__::template transition<&__TWI__::onMasterTransmit>,      /* 0x18 TW_MT_SLA_ACK */
+    &__TWI__::template transition<&__TWI__::onMasterNack>,          /* 0x20 TW_MT_SLA_NACK */
+    &__TWI__::template transition<&__TWI__::onMasterTransmit>,      /* 0x28 TW_MT_DATA_ACK */
+    &__TWI__::template transition<&__TWI__::onMasterNack>,          /* 0x30 TW_MT_DATA_NACK */
+    &__TWI__::template transition<&__TWI__::onArbitrationLost>,     /* 0x38 TW_MT_ARB_LOST, TW_MR_ARB_LOST */
+    &__TWI__::template transition<&__TWI__::onMasterReceive>,       /* 0x40 TW_MR_SLA_ACK */
+    &__TWI__::template transition<&__TWI__::onMasterNack>,          /* 0x48 TW_MR_SLA_NACK */
+    &__TWI__::template transition<&__TWI__::onMasterData>,          /* 0x50 TW_MR_DATA_ACK */
+    &__TWI__::template transition<&__TWI__::onMasterLastData>,      /* 0x58 TW_MR_DATA_NACK */
+    &__TWI__::template transition<&__TWI__::onSlaveReceive>,        /* 0x60 TW_SR_SLA_ACK */
+    &__TWI__::template transition<&__TWI__::onSlaveReceive>,        /* 0x68 TW_SR_ARB_LOST_SLA_ACK */
+    &__TWI__::template transition<&__TWI__::onSlaveReceive>,        /* 0x70 TW_SR_GCALL_ACK */
+    &__TWI__::template transition<&__TWI__::onSlaveReceive>,        /* 0x78 TW_SR_ARB_LOST_GCALL_ACK */
+    &__TWI__::template transition<&__TWI__::onSlaveData>,           /* 0x80 TW_SR_DATA_ACK */
+    &__TWI__::template transition<&__TWI__::onSlaveReceiveEnd>,     /* 0x88 TW_SR_DATA_NACK */
+    &__TWI__::template transition<&__TWI__::onSlaveData>,           /* 0x90 TW_SR_GCALL_DATA_ACK */
+    &__TWI__::template transition<&__TWI__::onSlaveReceiveEnd>,     /* 0x98 TW_SR_GCALL_DATA_NACK */
+    &__TWI__::template transition<&__TWI__::onSlaveStop>,           /* 0xA0 TW_SR_STOP */
+    &__TWI__::template transition<&__TWI__::onSlaveTransmit>,       /* 0xA8 TW_ST_SLA_ACK */
+    &__TWI__::template transition<&__TWI__::onSlaveTransmit>,       /* 0xB0 TW_ST_ARB_LOST_SLA_ACK */
+    &__TWI__::template transition<&__TWI__::onSlaveTransmitData>,   /* 0xB8 TW_ST_DATA_ACK */
+    &__TWI__::template transition<&__TWI__::onSlaveTransmitEnd>,    /* 0xC0 TW_ST_DATA_NACK */
+    &__TWI__::template transition<&__TWI__::onSlaveTransmitEnd>,    /* 0xC8 TW_ST_LAST_DATA */
+    &__TWI__::template transition<&__TWI__::onNoInfo>,              /* 0xD0 unused */
+    &__TWI__::template transition<&__TWI__::onNoInfo>,              /* 0xD8 unused */
+    &__TWI__::template transition<&__TWI__::onNoInfo>,              /* 0xE0 unused */
+    &__TWI__::template transition<&__TWI__::onNoInfo>,              /* 0xE8 unused */
+    &__TWI__::template transition<&__TWI__::onNoInfo>,              /* 0xF0 unused */
+    &__TWI__::template transition<&__TWI__::onNoInfo>               /* 0xF8 TW_NO_INFO */
+};
+
+
+/**
+ * @brief START or repeated START sent: address the slave.
+ */
+template <class REGISTERS, uint16_t BUFFER_SIZE>
+void __TWI__<REGISTERS, BUFFER_SIZE>::onStart(void)
+{
+    REGISTERS::twdr() = this->address;  //*< Write the TWI address into the data register.
+    this->control(TWI_SEND_ACK);        //*< Clock it out.
+}
+
+
+/**
+ * @brief Address or data byte acknowledged as master transmitter: send the next byte.
+ * 
+ * Once all bytes are sent, the transaction either turns around into its read part or ends.
+ */
+template <class REGISTERS, uint16_t BUFFER_SIZE>
+void __TWI__<REGISTERS, BUFFER_SIZE>::onMasterTransmit(void)
+{
+    if (this->index < this->length)  //*< If there is more data to transmit
+    {
+        const uint16_t index = this->index++;  //*< The byte to send.
+        const uint8_t byte = (index < this->split) ? this->txData[index] : this->txNext[index - this->split];  //*< Fetch it from the buffer it lives in.
+        REGISTERS::twdr() = byte;              //*< Write it into TWDR...
+        this->control(TWI_SEND_ACK);           //*< ...and clock it out.
+        if (this->smbus)                       //*< Update the PEC while the byte is shifted out.
+            this->crc = crc8(this->crc, byte);
+    }
+    else if (this->smbus & TWI_SMBUS_APPEND)  //*< All data sent, an SMBus write closes with its PEC
+    {
+        this->smbus &= ~TWI_SMBUS_APPEND;  //*< Only once.
+        REGISTERS::twdr() = this->crc;     //*< Send the PEC...
+        this->control(TWI_SEND_ACK);       //*< ...then end the transaction on its ACK.
+    }
+    else if (this->transaction->rxLength)  //*< All data sent, but the transaction reads as well
+        this->restart();                   //*< Send a repeated start and continue as master receiver.
+    else                                   //*< No more data to send
+        this->finish();                    //*< Send a stop or repeated start and set state to ready.
+}
+
+
+/**
+ * @brief Address or data byte not acknowledged as master: end the transaction.
+ * 
+ * A refused address is retried while the transaction has ACK polls left, so a device 
+ * busy with its write cycle is addressed again as soon as possible. Otherwise the 
+ * transaction is repeated while it has retries left: at once, or after its backoff 
+ * counted down by `tick()`; from the start, or from the refused byte if it resumes. 
+ * SMBus transactions always start over: their PEC covers every byte since the START.
+ */
+template <class REGISTERS, uint16_t BUFFER_SIZE>
+void __TWI__<REGISTERS, BUFFER_SIZE>::onMasterNack(void)
+{
+    if (this->polls && this->status != TW_MT_DATA_NACK)  //*< The address was refused, poll it again.
+    {
+        this->polls--;                        //*< One retry less.
+        this->control(TWI_SEND_STOP_START);   //*< STOP, then START with the same address.
+        return;
+    }
+
+    if (this->retries)  //*< The transaction may be repeated.
+    {
+        const uint8_t retries = this->retries - 1;  //*< One retry less.
+        if (this->status == TW_MT_DATA_NACK && this->transaction->resume && !this->transaction->smbus)  //*< Continue at the refused byte...
+            this->index--;
+        else                                                               //*< ...or start over.
+            this->load(this->transaction, this->sendStop);
+        this->retries = retries;
+#ifdef TWI_INSTRUMENTATION
+        this->stats.retries++;
+#endif
+
+        if (!this->transaction->backoff)         //*< Retry right away...
+        {
+            this->control(TWI_SEND_STOP_START);  //*< ...with STOP, then START.
+            return;
+        }
+
+        this->stop();                                      //*< Leave the bus silent...
+        this->backoff = this->transaction->backoff;        //*< ...until tick() has counted the backoff down.
+        return;
+    }
+
+    this->stop();      //*< Send a stop condition.
+    this->complete();  //*< Finish the transaction.
+}
+
+
+/**
+ * @brief Arbitration lost as master: leave the bus to the other master.
+ */
+template <class REGISTERS, uint16_t BUFFER_SIZE>
+void __TWI__<REGISTERS, BUFFER_SIZE>::onArbitrationLost(void)
+{
+    this->releaseBus();  //*< Release the bus for other masters.
+    this->complete();    //*< Finish the transaction.
+}
+
+
+/**
+ * @brief Data byte received and acknowledged as master: store it and receive the next one.
+ * 
+ * The first byte of an SMBus block read is the block count: it is not stored, but sizes 
+ * the rest of the read before the next byte is requested.
+ */
+template <class REGISTERS, uint16_t BUFFER_SIZE>
+void __TWI__<REGISTERS, BUFFER_SIZE>::onMasterData(void)
+{
+    const uint8_t byte = REGISTERS::twdr();  //*< The received byte.
+
+    if (this->smbus & TWI_SMBUS_BLOCK)  //*< The block count of an SMBus block read
+    {
+        this->smbus &= ~TWI_SMBUS_BLOCK;  //*< Only the first byte.
+        if (byte > this->transaction->rxLength)  //*< The block doesn't fit: NACK after what does, no PEC to check.
+        {
+            this->smbus = TWI_SMBUS_TRUNCATED;
+            this->length = this->transaction->rxLength;
+        }
+        else
+            this->length = byte + (this->smbus & TWI_SMBUS_PEC);  //*< Read the block, plus the PEC.
+    }
+    else
+        this->rxData[this->index++] = byte;  //*< Store received byte.
+
+    this->onMasterReceive();  //*< Ask for the next one.
+    if (this->smbus)          //*< Update the PEC while the next byte is shifted in.
+        this->crc = crc8(this->crc, byte);
+}
+
+
+/**
+ * @brief Ready to receive as master: ACK all but the last byte, NACK the last one.
+ */
+template <class REGISTERS, uint16_t BUFFER_SIZE>
+void __TWI__<REGISTERS, BUFFER_SIZE>::onMasterReceive(void)
+{
+    this->control((this->index + 1 < this->length) ? TWI_SEND_ACK : TWI_SEND_NACK);  //*< More than one byte left gets an ACK.
+}
+
+
+/**
+ * @brief Last data byte received as master: store it and end the transaction.
+ * 
+ * With SMBus PEC the last byte is the PEC of the message, it is checked instead of stored. 
+ * A truncated block read keeps the byte only if it fits, and reports the truncation.
+ */
+template <class REGISTERS, uint16_t BUFFER_SIZE>
+void __TWI__<REGISTERS, BUFFER_SIZE>::onMasterLastData(void)
+{
+    if (this->smbus & TWI_SMBUS_PEC)  //*< The last byte is the PEC
+    {
+        if (REGISTERS::twdr() != this->crc)  //*< Compare it with the one computed on the fly.
+            this->status = TWI_ERROR_PEC;    //*< Report the corrupted message.
+    }
+    else if (this->index < this->length)                  //*< Nothing fits when the block met an empty destination.
+        this->rxData[this->index++] = REGISTERS::twdr();  //*< Store received byte.
+    if (this->smbus & TWI_SMBUS_TRUNCATED)    //*< The device had more than the destination holds.
+        this->status = TWI_ERROR_TRUNCATED;
+    this->finish();                                       //*< Send a stop or repeated start and set state to ready.
+}
+
+
+/**
+ * @brief Addressed as slave receiver: pick where the bytes go.
+ * 
+ * The register map takes precedence, then the ring (its data is NACKed when full), 
+ * then the buffer.
+ */
+template <class REGISTERS, uint16_t BUFFER_SIZE>
+void __TWI__<REGISTERS, BUFFER_SIZE>::onSlaveReceive(void)
+{
+    this->state = TWI_SRX;  //*< Set state to slave receiver.
+    this->bufferIndex = 0;  //*< Reset buffer index.
+    this->joined = 0;       //*< A write always starts a message of its own.
+    this->match();          //*< Latch the address the master wrote to.
+    this->crc = this->pec ? crc8(0, REGISTERS::twdr()) : 0;  //*< A new message, its PEC starts with the address byte.
+    if (this->registerMap != NULL)  //*< If a register map is served
+        this->registerPending = 1;  //*< The first written byte sets the register pointer.
+#ifndef TWI_LEAN
+    else if (this->ring != NULL)    //*< If frames are collected in the ring
+    {
+        uint8_t next = this->ringHead + 1;  //*< Find the frame behind the one to fill.
+        if (next >= this->ringSize)         //*< Wrap around the end of the ring.
+            next = 0;
+        this->frame = (next != this->ringTail) ? &this->ring[this->ringHead] : NULL;  //*< Fill the head frame unless the ring is full.
+        if (this->frame == NULL)  //*< No room left for this frame
+        {
+            this->control(TWI_SEND_NACK);  //*< NACK its data instead of overwriting a frame.
+            return;
+        }
+        this->frame->address = this->matched;  //*< Tag the frame with the address it was written to.
+        this->frame->length = 0;               //*< Start with an empty frame.
+    }
+#endif
+    this->control(TWI_SEND_ACK);  //*< Send ACK.
+}
+
+
+/**
+ * @brief Data byte received as slave: store it and decide whether to take another one.
+ */
+template <class REGISTERS, uint16_t BUFFER_SIZE>
+void __TWI__<REGISTERS, BUFFER_SIZE>::onSlaveData(void)
+{
+    const uint8_t byte = REGISTERS::twdr();  //*< The received byte.
+
+    if (this->registerMap != NULL)  //*< If a register map is served
+    {
+        this->writeRegister(byte);               //*< Store the byte or move the register pointer.
+        this->control(TWI_SEND_ACK);             //*< Keep accepting bytes.
+    }
+#ifndef TWI_LEAN
+    else if (this->frame != NULL)  //*< If the byte goes into a ring frame
+    {
+        this->frame->data[this->frame->length++] = byte;  //*< Store received data byte.
+        this->control((this->frame->length < TWI_FRAME_SIZE) ? TWI_SEND_ACK : TWI_SEND_NACK);  //*< ACK while the frame has room.
+    }
+#endif
+    else if (this->bufferIndex < BUFFER_SIZE)  //*< If there is space in the buffer
+    {
+        this->buffer[this->bufferIndex++] = byte;  //*< Store received data byte.
+        this->control(TWI_SEND_ACK);               //*< Send ACK.
+    }
+    else
+        this->control(TWI_SEND_NACK);  //*< Send NACK.
+
+    if (this->pec)  //*< Update the PEC while the next byte is shifted in.
+        this->crc = crc8(this->crc, byte);
+}
+
+
+/**
+ * @brief STOP or repeated START received as slave: the frame is complete.
+ * 
+ * Both end with the same status. A STOP leaves both lines high, after a repeated START 
+ * the master has pulled SDA low and SCL follows, so the lines tell them apart: only a 
+ * repeated START carries the PEC of the frame over to a read that follows.
+ */
+template <class REGISTERS, uint16_t BUFFER_SIZE>
+void __TWI__<REGISTERS, BUFFER_SIZE>::onSlaveStop(void)
+{
+    const uint8_t lines = (1 << REGISTERS::SCL) | (1 << REGISTERS::SDA);  //*< Both lines high after a STOP.
+    this->joined = ((REGISTERS::pin() & lines) != lines);                 //*< Sampled while TWINT still holds the bus.
+    this->stop();               //*< Send stop condition.
+    this->onSlaveReceiveEnd();  //*< Finish the frame.
+}
+
+
+/**
+ * @brief Slave reception ended: hand the frame over and listen again.
+ */
+template <class REGISTERS, uint16_t BUFFER_SIZE>
+void __TWI__<REGISTERS, BUFFER_SIZE>::onSlaveReceiveEnd(void)
+{
+    this->pecValid = this->pec && !this->crc;  //*< Including its PEC, a sound message sums up to zero.
+    this->receiveDone();  //*< Hand the frame to the application.
+    this->releaseBus();   //*< Release the bus and keep recognizing our own address.
+}
+
+
+/**
+ * @brief Addressed as slave transmitter: prepare the reply and send its first byte.
+ * 
+ * The register map is served without callbacks; otherwise the TX callback of the 
+ * matched device, or the general one, fills the buffer. An empty reply sends `0xFF`.
+ */
+template <class REGISTERS, uint16_t BUFFER_SIZE>
+void __TWI__<REGISTERS, BUFFER_SIZE>::onSlaveTransmit(void)
+{
+    this->state = TWI_STX;  //*< Set state to slave transmitter.
+    this->match();          //*< Latch the address the master reads from.
+    if (this->pec)          //*< The reply continues the PEC of a command joined by a repeated START, or starts one of its own.
+        this->crc = crc8(this->joined ? this->crc : 0, REGISTERS::twdr());
+    this->joined = 0;       //*< The next read starts over unless another repeated START joins it.
+    if (this->registerMap != NULL)  //*< If a register map is served
+    {
+        this->readRegister();  //*< Serve the register at the pointer, no callback involved.
+        return;
+    }
+    if (this->txProducer != NULL)  //*< If the bytes are produced one by one
+    {
+        this->produce();  //*< Send the first one, nothing is prepared up front.
+        return;
+    }
+    this->bufferIndex = 0;  //*< Reset buffer index.
+    this->bufferSize = 0;   //*< Reset buffer size.
+    if (this->handler != NULL && this->handler->txCallback != NULL)  //*< If the matched device has its own TX callback
+        this->handler->txCallback();                                 //*< Call it.
+    else if (this->txCallback != NULL)  //*< If a TX callback is set
+        this->txCallback();             //*< Call the TX callback.
+
+    if (!this->bufferSize)  //*< If no data is in buffer
+    {
+        this->bufferSize++;      //*< Add a dummy byte to the buffer.
+        this->buffer[0] = 0xFF;  //*< Store a dummy byte.
+    }
+    this->onSlaveTransmitData();  //*< Send the first byte.
+}
+
+
+/**
+ * @brief Data byte acknowledged as slave transmitter: send the next one.
+ * 
+ * The last byte of the buffer is sent with TWEA cleared, so the hardware expects the 
+ * master to NACK it. With SMBus PEC the PEC is sent after the buffer as the last byte.
+ */
+template <class REGISTERS, uint16_t BUFFER_SIZE>
+void __TWI__<REGISTERS, BUFFER_SIZE>::onSlaveTransmitData(void)
+{
+    if (this->registerMap != NULL)  //*< If a register map is served
+    {
+        this->readRegister();  //*< Serve the next register.
+        return;
+    }
+    if (this->txProducer != NULL)  //*< If the bytes are produced one by one
+    {
+        this->produce();  //*< Pull the next one.
+        return;
+    }
+    const uint8_t byte = (this->bufferIndex < this->bufferSize) ? this->buffer[this->bufferIndex] : this->crc;  //*< The next byte from the buffer, then the PEC.
+    this->bufferIndex++;
+    REGISTERS::twdr() = byte;  //*< Send it.
+    this->control((this->bufferIndex < this->bufferSize + this->pec) ? TWI_SEND_ACK : TWI_SEND_NACK);  //*< Expect more only while data is left.
+    if (this->pec)             //*< Update the PEC while the byte is shifted out.
+        this->crc = crc8(this->crc, byte);
+}
+
+
+/**
+ * @brief Sends the next byte of the slave TX producer.
+ * 
+ * The producer always has another byte, so TWEA stays set and the master ends the read.
+ */
+template <class REGISTERS, uint16_t BUFFER_SIZE>
+void __TWI__<REGISTERS, BUFFER_SIZE>::produce(void)
+{
+    REGISTERS::twdr() = this->txProducer();  //*< Pull the byte from the producer.
+    this->control(TWI_SEND_ACK);             //*< Expect the master to keep reading.
+}
+
+
+/**
+ * @brief Slave transmission ended: listen again.
+ */
+template <class REGISTERS, uint16_t BUFFER_SIZE>
+void __TWI__<REGISTERS, BUFFER_SIZE>::onSlaveTransmitEnd(void)
+{
+    this->control(TWI_SEND_ACK);  //*< Send ACK to finalize transmission.
+    this->state = TWI_READY;      //*< Set state to ready for next transaction.
+}
+
+
+/**
+ * @brief No relevant state information: nothing to do.
+ */
+template <class REGISTERS, uint16_t BUFFER_SIZE>
+void __TWI__<REGISTERS, BUFFER_SIZE>::onNoInfo(void)
+{
+}
+
+
+/**
+ * @brief Illegal START or STOP on the bus: release it and abort the master transaction.
+ */
+template <class REGISTERS, uint16_t BUFFER_SIZE>
+void __TWI__<REGISTERS, BUFFER_SIZE>::onBusError(void)
+{
+    this->stop();      //*< Send stop condition to recover from error.
+    this->complete();  //*< Finish any master transaction that was in flight.
+}
+
+
+#ifdef TWI_INSTRUMENTATION
+/**
+ * @brief Counts and traces a status code seen by the ISR.
+ * 
+ * The code is stored in the trace ring with a timestamp and classified into the byte 
+ * and error counters.
+ * 
+ * @param status The TWSR status code with the prescaler bits masked out.
+ */
+template <class REGISTERS, uint16_t BUFFER_SIZE>
+void __TWI__<REGISTERS, BUFFER_SIZE>::record(const uint8_t status)
+{
+    TWI_TraceEntry* entry = &this->stats.trace[this->stats.traceHead];  //*< Overwrite the oldest entry.
+    entry->status = status;                                           //*< Store the status code...
+    entry->time = TWI_TRACE_TIMESTAMP();                              //*< ...and when it was seen.
+    if (++this->stats.traceHead >= TWI_TRACE_SIZE)                    //*< Advance around the end of the ring.
+        this->stats.traceHead = 0;
+
+    switch (status)  //*< Classify the status.
+    {
+        case TW_MT_DATA_NACK:  //*< A byte was sent, but refused.
+            this->stats.dataNacks++;  //*< The byte was still sent...
+            // fall through
+        case TW_MT_DATA_ACK:
+        case TW_ST_DATA_ACK:
+        case TW_ST_DATA_NACK:
+        case TW_ST_LAST_DATA:
+            this->stats.txBytes++;  //*< A data byte went out.
+            break;
+
+        case TW_MR_DATA_ACK:
+        case TW_MR_DATA_NACK:
+        case TW_SR_DATA_ACK:
+        case TW_SR_DATA_NACK:
+        case TW_SR_GCALL_DATA_ACK:
+        case TW_SR_GCALL_DATA_NACK:
+            this->stats.rxBytes++;  //*< A data byte came in.
+            break;
+
+        case TW_MT_SLA_NACK:
+        case TW_MR_SLA_NACK:
+            this->stats.slaNacks++;  //*< Nobody answered the address.
+            break;
+
+        case TW_MT_ARB_LOST:
+        case TW_SR_ARB_LOST_SLA_ACK:
+        case TW_SR_ARB_LOST_GCALL_ACK:
+        case TW_ST_ARB_LOST_SLA_ACK:
+            this->stats.arbitrationLost++;  //*< Another master won the bus.
+            break;
+
+        case TW_BUS_ERROR:
+            this->stats.busErrors++;  //*< Illegal START or STOP condition.
+            break;
+    }
+}
+
+
+/**
+ * @brief Copies the counters and the status trace of the bus.
+ * 
+ * The copy is taken with interrupts disabled, so all values belong to the same moment. 
+ * The trace is a ring: the oldest entry is at `stats->traceHead`, entries that were never 
+ * written have a status and time of `0`.
+ * 
+ * @param stats Pointer to the structure receiving the copy.
+ */
+template <class REGISTERS, uint16_t BUFFER_SIZE>
+void __TWI__<REGISTERS, BUFFER_SIZE>::snapshot(TWI_Stats* stats)
+{
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)  /**< Keep the ISR from updating the counters while copying. */
+    {
+        *stats = this->stats;  /**< Copy everything at once. */
+    }
+}
+
+
+/**
+ * @brief Clears the counters and the status trace of the bus.
+ */
+template <class REGISTERS, uint16_t BUFFER_SIZE>
+void __TWI__<REGISTERS, BUFFER_SIZE>::resetStats(void)
+{
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)  /**< Keep the ISR from updating the counters while clearing. */
+    {
+        this->stats = TWI_Stats();  /**< Zero every counter and trace entry. */
+    }
+}
+#endif
+
+
+/**
+ * @brief Finishes a frame received in slave mode.
+ * 
+ * With a ring registered, the frame being filled is published to the consumer. Otherwise 
+ * the received size is stored so the bytes can be drained with `read()` and the RX 
+ * callback is called with that size.
+ */
+template <class REGISTERS, uint16_t BUFFER_SIZE>
+void __TWI__<REGISTERS, BUFFER_SIZE>::receiveDone(void)
+{
+    if (this->registerMap != NULL)  //*< Register writes were applied byte by byte.
+        return;
+
+#ifndef TWI_LEAN
+    if (this->ring != NULL)  //*< Frames are collected in the ring.
+    {
+        if (this->frame != NULL && this->frame->length)  //*< Only publish frames that carry data.
+        {
+            uint8_t next = this->ringHead + 1;  //*< Advance the head...
+            if (next >= this->ringSize)        //*< ...around the end of the ring.
+                next = 0;
+            this->ringHead = next;             //*< Publish the frame to the consumer.
+        }
+        this->frame = NULL;  //*< No frame is being filled anymore.
+        return;
+    }
+#endif
+
+    this->bufferSize = this->bufferIndex;  //*< Store the received buffer size.
+    this->bufferIndex = 0;                 //*< Rewind the buffer for reading.
+    if (this->handler != NULL && this->handler->rxCallback != NULL)  //*< If the matched device has its own RX callback
+        this->handler->rxCallback(this->bufferSize);                 //*< Call it with the number of received bytes.
+    else if (this->rxCallback != NULL)     //*< If an RX callback function is set
+        this->rxCallback(this->bufferSize); //*< Call the RX callback with the number of received bytes.
+}
+
+
+/**
+ * @brief Stores a byte written by the master into the register map.
+ * 
+ * The first byte of every write sets the register pointer, following bytes are stored 
+ * at the pointer unless the register is read-only. The pointer auto-increments and 
+ * wraps around the end of the map.
+ * 
+ * @param byte The byte received from the master.
+ */
+template <class REGISTERS, uint16_t BUFFER_SIZE>
+void __TWI__<REGISTERS, BUFFER_SIZE>::writeRegister(const uint8_t byte)
+{
+    if (this->registerPending)  //*< The first byte addresses a register.
+    {
+        this->registerPending = 0;                                 //*< Following bytes are data.
+        this->registerPointer = (byte < this->registerCount) ? byte : 0;  //*< Out of range pointers start over at register 0.
+        return;
+    }
 
-        case TW_MT_ARB_LOST:  /**< Arbitration lost as master */
-            this->releaseBus();  /**< Release the bus for other masters. */
-            break;
-            
-        /* MASTER RECEIVER */
-        case TW_MR_DATA_ACK:  /**< Data received, returned ACK */
-            this->buffer[this->bufferIndex++] = *this->twdr;  /**< Store received byte in buffer. */
-            // Fall through to TW_MR_SLA_ACK case.
-        case TW_MR_SLA_ACK:  /**< Addressed, returned ACK */
-            if (this->bufferIndex < this->bufferSize)  /**< If there’s more data to receive */
-                *this->twcr = TWI_SEND_ACK;  /**< Send ACK for the next byte. */
-            else  /**< If all data has been received */
-                *this->twcr = TWI_SEND_NACK;  /**< Send NACK. */
-            break;
+    const uint8_t pointer = this->registerPointer;  //*< The register to write.
 
-        case TW_MR_DATA_NACK:  /**< Data received, returned NACK */
-            this->buffer[this->bufferIndex++] = *this->twdr;  /**< Store received byte. */
-            if (this->sendStop)
-                this->stop();  /**< Send stop if requested. */
-            else
-            {
-                this->inRepStart = 1;  /**< Mark that we are in repeated start. */
-                *this->twcr = TWI_SEND_REP_START;  /**< Send a repeated start. */
-                this->state = TWI_READY;  /**< Set state to ready. */
-            } 
-            break;
+    if (this->readOnlyMask == NULL || !(this->readOnlyMask[pointer >> 3] & (1 << (pointer & 7))))  //*< Writable register
+        this->registerMap[pointer] = byte;                                                         //*< Store the byte.
 
-        case TW_MR_SLA_NACK:  /**< Addressed, returned NACK */
-            this->stop();  /**< Send stop condition. */
-            break;
+    this->registerPointer = (pointer + 1 < this->registerCount) ? (pointer + 1) : 0;  //*< Auto-increment and wrap.
+}
 
-        /* SLAVE RECEIVER */
-        case TW_SR_SLA_ACK:  /**< Addressed, returned ACK */
-        case TW_SR_GCALL_ACK:  /**< Addressed generally, returned ACK */
-        case TW_SR_ARB_LOST_SLA_ACK:  /**< Lost arbitration in slave addressing */
-        case TW_SR_ARB_LOST_GCALL_ACK:  /**< Lost arbitration in general call */
-            this->state = TWI_SRX;  /**< Set state to slave receiver. */
-            this->bufferIndex = 0;  /**< Reset buffer index. */
-            *this->twcr = TWI_SEND_ACK;  /**< Send ACK. */
-            break;
-        
-        case TW_SR_DATA_ACK:  /**< Data received, returned ACK */
-        case TW_SR_GCALL_DATA_ACK:  /**< Data received generally, returned ACK */
-            if (this->bufferIndex < TWI_BUFFER_SIZE)  /**< If there is space in the buffer */
-            {
-                this->buffer[this->bufferIndex++] = *this->twdr;  /**< Store received data byte. */
-                *this->twcr = TWI_SEND_ACK;  /**< Send ACK. */
-            }
-            else
-                *this->twcr = TWI_SEND_NACK;  /**< Send NACK. */
-            break;
 
-        case TW_SR_STOP:  /**< Stop or repeated start received */
-            this->stop();  /**< Send stop condition. */
-            this->bufferSize = this->bufferIndex;  /**< Store the received buffer size. */
-            this->bufferIndex = 0;  /**< Reset the buffer index. */
-            if (this->rxCallback != NULL)  /**< If an RX callback function is set */
-                this->rxCallback(this->bufferIndex);  /**< Call the RX callback. */
-            this->releaseBus();  /**< Release the bus for other devices. */
-            break;
+/**
+ * @brief Serves the next register of the register map to the master.
+ * 
+ * Write-only registers read as `0xFF`. The pointer auto-increments and wraps around the 
+ * end of the map, so the master can read as many bytes as it wants.
+ */
+template <class REGISTERS, uint16_t BUFFER_SIZE>
+void __TWI__<REGISTERS, BUFFER_SIZE>::readRegister(void)
+{
+    const uint8_t pointer = this->registerPointer;  //*< The register to read.
 
-        case TW_SR_DATA_NACK:  /**< Data received, returned NACK */
-        case TW_SR_GCALL_DATA_NACK:  /**< Data received generally, returned NACK */
-            *this->twcr = TWI_SEND_NACK;  /**< Send NACK to master. */
-            break;
+    if (this->writeOnlyMask == NULL || !(this->writeOnlyMask[pointer >> 3] & (1 << (pointer & 7))))  //*< Readable register
+        REGISTERS::twdr() = this->registerMap[pointer];                                             //*< Send its value.
+    else
+        REGISTERS::twdr() = 0xFF;  //*< Send a dummy byte.
 
-        /* SLAVE TRANSMITTER */
-        case TW_ST_SLA_ACK:  /**< Addressed, returned ACK */
-        case TW_ST_ARB_LOST_SLA_ACK:  /**< Lost arbitration, returned ACK */
-            this->state = TWI_STX;  /**< Set state to slave transmitter. */
-            this->bufferIndex = 0;  /**< Reset buffer index. */
-            this->bufferSize = 0;  /**< Reset buffer size. */
-            if (this->txCallback != NULL)  /**< If a TX callback is set */
-                this->txCallback();  /**< Call the TX callback. */
+    this->registerPointer = (pointer + 1 < this->registerCount) ? (pointer + 1) : 0;  //*< Auto-increment and wrap.
+    this->control(TWI_SEND_ACK);  //*< Expect the master to keep reading.
+}
 
-            if (!this->bufferSize)  /**< If no data is in buffer */
-            {
-                this->bufferSize++;  /**< Add a dummy byte to the buffer. */
-                this->buffer[0] = 0xFF;  /**< Store a dummy byte. */
-            }
-            // NO NEED FOR BRAKE
-        case TW_ST_DATA_ACK:  /**< Data transmitted, returned ACK */
-            *this->twdr = this->buffer[this->bufferIndex++];  /**< Send the next byte from the buffer. */
-            if (this->bufferIndex < this->bufferSize)  /**< If there’s more data to send */
-                *this->twcr = TWI_SEND_ACK;  /**< Send ACK. */
-            else  /**< If no more data to send */
-                *this->twcr = TWI_SEND_NACK;  /**< Send NACK. */
-            break;
 
-        case TW_ST_DATA_NACK:  /**< Data sent, returned NACK */
-        case TW_ST_LAST_DATA:  /**< Last data sent, returned ACK */
-            *this->twcr = TWI_SEND_ACK;  /**< Send ACK to finalize transmission. */
-            this->state = TWI_READY;  /**< Set state to ready for next transaction. */
-            break;
+/**
+ * @brief Latches the matched slave address and selects its handler.
+ * 
+ * Right after the own address was ACKed, TWDR still holds the received SLA+R/W byte. 
+ * With an address mask this tells which of the answered addresses the master used.
+ */
+template <class REGISTERS, uint16_t BUFFER_SIZE>
+void __TWI__<REGISTERS, BUFFER_SIZE>::match(void)
+{
+    const uint8_t address = REGISTERS::twdr() >> 1;  //*< Drop the R/W bit.
 
-        /* BOTH MASTER AND SLAVE */
-        case TW_NO_INFO:  /**< No information, do nothing */
-            break;
+    this->matched = address;  //*< Remember the address.
+    this->handler = NULL;     //*< Fall back to the plain callbacks unless a handler matches.
 
-        case TW_BUS_ERROR:  /**< Bus error occurred */
-            this->stop();  /**< Send stop condition to recover from error. */
+    for (uint8_t index = 0; index < this->handlerCount; index++)  //*< Look the address up in the table.
+    {
+        if (this->handlers[index].address == address)
+        {
+            this->handler = &this->handlers[index];  //*< Dispatch to this virtual device.
             break;
+        }
     }
 }
 
 
+/**
+ * @brief Updates an SMBus Packet Error Code with a byte.
+ * 
+ * CRC-8 with the polynomial x^8 + x^2 + x + 1 (0x07), computed bit by bit without 
+ * branches: the top bit is turned into a mask selecting the polynomial, so every byte 
+ * takes the same time and no table is needed in flash. The ISR calls it after writing 
+ * TWCR, while the hardware shifts the byte, so it adds no latency on the bus.
+ * 
+ * @param crc The PEC so far.
+ * @param byte The byte to add.
+ * 
+ * @return The updated PEC.
+ */
+template <class REGISTERS, uint16_t BUFFER_SIZE>
+const uint8_t __TWI__<REGISTERS, BUFFER_SIZE>::crc8(uint8_t crc, const uint8_t byte)
+{
+    crc ^= byte;  //*< Add the byte.
+
+    for (uint8_t bit = 0; bit < 8; bit++)  //*< Divide by the polynomial, one bit at a time.
+        crc = (crc << 1) ^ (TWI_SMBUS_POLYNOMIAL & -(crc >> 7));
+
+    return (crc);
+}
+
+
 /**
  * @brief Releases the TWI bus and sets the state to ready.
  * 
@@ -668,27 +2444,583 @@ void __TWI__::isr(void)
  * 
  * @note This function is called when the bus should be released after a transmission.
  */
-void __TWI__::releaseBus(void)
+template <class REGISTERS, uint16_t BUFFER_SIZE>
+void __TWI__<REGISTERS, BUFFER_SIZE>::releaseBus(void)
 {
-    *this->twcr = TWI_SEND_ACK;  //*< Acknowledge current transaction, releasing the bus.
+    this->control(TWI_SEND_ACK);  //*< Acknowledge current transaction, releasing the bus.
     this->state = TWI_READY;     //*< Set state to ready for future operations.
 }
 
 
 /**
- * @brief Sends a stop condition on the TWI bus and waits until the stop condition is completed.
+ * @brief Sends a stop condition on the TWI bus.
  * 
  * This function sends a stop condition to the TWI bus, signaling the end of the communication
- * and allowing other devices to use the bus. It waits for the stop condition to be fully transmitted
- * by checking the TWSTO flag in the TWI Control Register. Once the stop condition is finished,
- * the state is set to TWI_READY to indicate that the bus is ready for future communications.
+ * and allowing other devices to use the bus. It doesn't wait for the stop condition: the 
+ * hardware clears TWSTO once it is on the wire, a START issued meanwhile follows it (see 
+ * `launch()`), and the foreground checks it with `stopped()`.
+ * 
+ * @note This function is typically called to terminate a communication session. The 
+ *       state is left untouched; callers mark the bus ready through `complete()`.
+ */
+template <class REGISTERS, uint16_t BUFFER_SIZE>
+void __TWI__<REGISTERS, BUFFER_SIZE>::stop(void)
+{
+    this->control(TWI_SEND_STOP);        //*< Initiate a stop condition.
+}
+
+
+/**
+ * @brief Waits for the last stop condition to be on the wire.
+ * 
+ * Called by the foreground, never by the ISR. The wait is bounded by `TWI_STOP_TIMEOUT` 
+ * microseconds; a slave holding SCL low for longer makes the bus stuck.
+ * 
+ * @return `1` if TWSTO is clear, `0` if the stop condition did not complete in time.
+ */
+template <class REGISTERS, uint16_t BUFFER_SIZE>
+const uint8_t __TWI__<REGISTERS, BUFFER_SIZE>::stopped(void)
+{
+    for (uint8_t spins = TWI_STOP_TIMEOUT; REGISTERS::twcr() & (1 << TWSTO); spins--)  //*< Wait until stop condition is finished...
+    {
+        if (!spins)     //*< ...but not forever.
+            return (0);
+        _delay_us(1);
+    }
+
+    return (1);
+}
+
+
+/**
+ * @brief Writes the TWI control register.
+ * 
+ * Every control word goes through here, so polling mode can keep TWIE cleared.
+ * 
+ * @param value The control word to write.
+ */
+template <class REGISTERS, uint16_t BUFFER_SIZE>
+void __TWI__<REGISTERS, BUFFER_SIZE>::control(const uint8_t value)
+{
+    REGISTERS::twcr() = value & this->controlMask;  //*< Strip TWIE in polling mode.
+}
+
+
+/**
+ * @brief Waits until the TWI interface is ready for a new master transaction.
+ * 
+ * The wait is bounded by the timeout set with `setTimeout()`. If the bus makes no progress 
+ * for that long, the transaction in flight is aborted with `TWI_ERROR_TIMEOUT` and the bus 
+ * is recovered.
+ * 
+ * @return `1` if the interface is ready, `0` if it did not become ready in time.
+ */
+template <class REGISTERS, uint16_t BUFFER_SIZE>
+const uint8_t __TWI__<REGISTERS, BUFFER_SIZE>::idle(void)
+{
+    uint16_t remaining = this->timeout;  //*< Time left without bus progress.
+    uint8_t seen = this->activity;       //*< The last observed ISR activity.
+
+    while (this->state != TWI_READY)  //*< Wait for the TWI interface to be ready.
+    {
+        if (this->expired(&remaining, &seen, this->timeout))  //*< The bus made no progress in time.
+        {
+            this->recoverBus(TWI_ERROR_TIMEOUT);  //*< Abort whatever hangs and clear the bus.
+            return (0);
+        }
+    }
+
+    return (1);
+}
+
+
+/**
+ * @brief Checks whether the bus made no progress for longer than the timeout.
+ * 
+ * Called once per iteration of a wait loop. Every ISR invocation counts as progress and 
+ * restarts the countdown, so long transfers don't time out as long as bytes keep moving. 
+ * Each call without progress waits about one microsecond, or sleeps until the next 
+ * interrupt if enabled with `setSleep()`.
+ * 
+ * @param remaining The microseconds left without progress, updated by the call.
+ * @param seen The last observed ISR activity, updated by the call.
+ * @param timeout The maximum time without progress in microseconds, `0` waits forever.
+ * 
+ * @return `1` if the timeout expired, `0` otherwise or if timeouts are disabled.
+ */
+template <class REGISTERS, uint16_t BUFFER_SIZE>
+const uint8_t __TWI__<REGISTERS, BUFFER_SIZE>::expired(uint16_t* remaining, uint8_t* seen, const uint16_t timeout)
+{
+#ifdef TWI_INSTRUMENTATION
+    this->stats.waitSpins++;  //*< Account the time spent waiting.
+#endif
+
+    this->poll();  //*< In polling mode the waiting foreground drives the bus itself.
+
+    if (*seen != this->activity)  //*< The ISR ran since the last check...
+    {
+        *seen = this->activity;  //*< ...remember it...
+        *remaining = timeout;    //*< ...and restart the countdown.
+        return (0);
+    }
+
+    uint16_t elapsed = 1;  //*< The time this call waits.
+
+    if (this->sleeping && (this->controlMask & (1 << TWIE)))  //*< Sleep until the next interrupt...
+    {
+        set_sleep_mode(SLEEP_MODE_IDLE);
+        cli();  //*< ...checking for progress with interrupts off, so the ISR can't slip in before sleeping.
+        if (*seen == this->activity)
+        {
+            sleep_enable();
+            sei();        //*< The instruction after SEI runs before any interrupt...
+            sleep_cpu();  //*< ...so one pending by now wakes the CPU right away.
+            sleep_disable();
+        }
+        sei();
+
+        if (*seen != this->activity)  //*< Woken by the TWI, that's progress.
+        {
+            *seen = this->activity;
+            *remaining = timeout;
+            return (0);
+        }
+
+        elapsed = TWI_SLEEP_TICK;  //*< Woken by another interrupt, assume a tick passed.
+    }
+    else
+    {
+        _delay_us(1);  //*< Let a microsecond pass.
+    }
+
+    if (this->backoff)  //*< A retry is backing off, that's no hang.
+    {
+        this->tick(elapsed);  //*< Count the time waited.
+        return (0);
+    }
+
+    if (!timeout)  //*< Timeouts are disabled, wait forever.
+        return (0);
+
+    *remaining = (*remaining > elapsed) ? *remaining - elapsed : 0;  //*< Count down...
+
+    return (!*remaining);  //*< ...expired once the countdown reaches zero.
+}
+
+
+/**
+ * @brief Aborts the current transaction and brings a stuck bus back to idle.
+ * 
+ * The TWI peripheral is switched off so SCL and SDA can be driven as open-drain GPIOs: a 
+ * line is either driven low or an input with its pull-up on, never driven high. While a 
+ * slave holds SDA low, up to nine SCL pulses are clocked out so it can finish the 
+ * byte it is sending, then a STOP condition is generated. Afterwards the peripheral is 
+ * re-initialized with the previous clock and address settings and a transaction in flight 
+ * is finished with the given status (or `TWI_ERROR_BUS_STUCK` if the bus is still held). 
+ * Interrupts are only disabled while the peripheral is switched off and re-initialized, 
+ * not while the lines are clocked.
+ * 
+ * @param status The status reported to the aborted transaction.
+ * 
+ * @return `1` if both lines are released, `0` if the bus is still stuck.
+ */
+template <class REGISTERS, uint16_t BUFFER_SIZE>
+const uint8_t __TWI__<REGISTERS, BUFFER_SIZE>::recoverBus(const uint8_t status)
+{
+    const uint8_t scl = (1 << REGISTERS::SCL);  //*< The SCL pin mask.
+    const uint8_t sda = (1 << REGISTERS::SDA);  //*< The SDA pin mask.
+    uint8_t port, ddr, released;
+
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)  //*< Keep the ISR away while the peripheral goes down.
+    {
+        port = REGISTERS::port();  //*< Remember the pull-up settings.
+        ddr = REGISTERS::ddr();    //*< Remember the pin directions.
+
+        REGISTERS::twcr() = TWI_END;  //*< Switch the TWI off, the pins become GPIOs; no TWI interrupt until re-enabled.
+        this->backoff = 0;            //*< A pending retry is abandoned with its transaction.
+        if (this->transaction == NULL)
+            this->state = TWI_MTX;    //*< Keep enqueue() and scan() from starting on the half reset bus.
+    }
+
+    lineRelease(scl | sda);  //*< Release both lines, pulled up while they are inputs.
+    _delay_us(5);
+
+    for (uint8_t pulse = 0; pulse < 9 && !(REGISTERS::pin() & sda); pulse++)  //*< Clock the slave until it lets go of SDA.
+    {
+        lineLow(scl);      //*< SCL low.
+        _delay_us(5);
+        lineRelease(scl);  //*< SCL released.
+        for (uint8_t spins = TWI_STOP_TIMEOUT; !(REGISTERS::pin() & scl) && spins; spins--)  //*< Honour clock stretching, bounded.
+            _delay_us(1);
+        _delay_us(5);
+    }
+
+    lineLow(sda);      //*< SDA low while SCL is high...
+    _delay_us(5);
+    lineRelease(sda);  //*< ...and released: a STOP condition.
+    _delay_us(5);
+
+    released = ((REGISTERS::pin() & (scl | sda)) == (scl | sda));  //*< Both lines must be high again.
+
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)  //*< Re-initialize before the ISR sees the peripheral again.
+    {
+        REGISTERS::port() = port;  //*< Restore the pull-up settings.
+        REGISTERS::ddr() = ddr;    //*< Restore the pin directions.
+
+        REGISTERS::twbr() = this->clock.twbr;  //*< Restore the bit rate...
+        REGISTERS::twsr() = this->clock.twps;  //*< ...and the prescaler.
+        this->control(TWI_BEGIN);         //*< Re-enable the TWI; TWAR/TWAMR keep their values.
+
+        this->inRepStart = 0;  //*< Nothing holds the bus anymore.
+
+        if (this->transaction != NULL)  //*< A master transaction was in flight.
+        {
+            this->status = released ? status : TWI_ERROR_BUS_STUCK;  //*< Report why it was aborted.
+            this->complete();  //*< Finish it and chain the next queued one.
+        }
+        else
+            this->state = TWI_READY;  //*< Mark the bus as ready for future communication.
+    }
+
+    return (released);
+}
+
+
+/**
+ * @brief Drives bus lines low as open-drain GPIOs.
+ * 
+ * The pull-up is switched off before the pin becomes an output, so the pin goes from 
+ * input straight to driving low and never drives the line high against a slave.
+ * 
+ * @param mask The pin mask of the lines.
+ */
+template <class REGISTERS, uint16_t BUFFER_SIZE>
+void __TWI__<REGISTERS, BUFFER_SIZE>::lineLow(const uint8_t mask)
+{
+    REGISTERS::port() &= ~mask;  //*< Pull-up off while still an input...
+    REGISTERS::ddr() |= mask;    //*< ...then drive low.
+}
+
+
+/**
+ * @brief Releases bus lines to their pull-ups.
+ * 
+ * The pin becomes an input before its pull-up is switched on, so the line floats high 
+ * instead of being driven; boards without external resistors rely on the internal ones.
+ * 
+ * @param mask The pin mask of the lines.
+ */
+template <class REGISTERS, uint16_t BUFFER_SIZE>
+void __TWI__<REGISTERS, BUFFER_SIZE>::lineRelease(const uint8_t mask)
+{
+    REGISTERS::ddr() &= ~mask;  //*< Stop driving...
+    REGISTERS::port() |= mask;  //*< ...then pull up.
+}
+
+
+/**
+ * @brief Finishes the current master transaction and sets the state to ready.
+ * 
+ * This function is called by the ISR once a master transaction has ended, either 
+ * successfully or with an error. For a reception it publishes the number of received 
+ * bytes so they can be drained with `read()`. It then marks the bus as ready and, if a 
+ * master transaction was in flight, invokes the completion callback with the final status.
+ */
+template <class REGISTERS, uint16_t BUFFER_SIZE>
+void __TWI__<REGISTERS, BUFFER_SIZE>::complete(void)
+{
+    TWI_Transaction* transaction = this->transaction;  //*< The transaction being finished, if any.
+
+    if (transaction != NULL)
+    {
+        transaction->status = this->status;  //*< Report the final status.
+        transaction->count = this->index;    //*< Report the number of transferred bytes.
+
+        if (transaction == &this->transfer && this->state == TWI_MRX)  //*< A buffered reception has finished...
+        {
+            this->bufferSize = this->index;  //*< Publish the number of received bytes.
+            this->bufferIndex = 0;           //*< Rewind the buffer for reading.
+        }
+
+        transaction->done = 1;      //*< Hand the transaction back to its owner.
+        this->transaction = NULL;  //*< Nothing is on the bus anymore.
+
+#ifndef TWI_LEAN
+        if (transaction == &this->scanTransfer)  //*< A scan entry has finished...
+        {
+            if (this->status != TW_MR_DATA_NACK)  //*< ...without reading all of its bytes.
+                this->scanFailed++;
+            if (++this->scanIndex >= this->scanCount)  //*< The pass is complete...
+                this->scanReady = 1;                   //*< ...publish the snapshot.
+        }
+#endif
+    }
+
+    this->state = TWI_READY;  //*< Mark the bus as ready for future communication.
+
+    if (transaction != NULL && this->doneCallback != NULL)  //*< Only master transactions report completion.
+        this->doneCallback(this->status);                  //*< Notify the application.
+
+    if (this->state != TWI_READY)  //*< The callback already started a transaction.
+        return;
+
+#ifndef TWI_LEAN
+    if (this->scanIndex < this->scanCount)  //*< A scan pass is running, its entries go first.
+        transaction = this->scanEntry();    //*< Prepare the next entry.
+    else
+#endif
+    if (this->queueCount)                   //*< Chain the next queued transaction.
+    {
+        transaction = this->queue[this->queueHead];  //*< Take the oldest entry.
+        if (++this->queueHead >= TWI_QUEUE_SIZE)     //*< Advance the head around the ring.
+            this->queueHead = 0;
+        this->queueCount--;                          //*< Account for the removed entry.
+    }
+    else
+        return;
+
+    this->load(transaction, 1);  //*< Prepare it for the ISR.
+    this->launch();              //*< Issue its START right away.
+}
+
+
+/**
+ * @brief Removes a transaction from the queue, keeping the order of the others.
+ * 
+ * Must be called with interrupts disabled.
+ * 
+ * @param transaction Pointer to the transaction to remove.
+ * 
+ * @return `1` if it was queued, `0` otherwise.
+ */
+template <class REGISTERS, uint16_t BUFFER_SIZE>
+const uint8_t __TWI__<REGISTERS, BUFFER_SIZE>::dequeue(TWI_Transaction* transaction)
+{
+    uint8_t slot = this->queueHead;  //*< The entry being looked at.
+    uint8_t found = 0;               //*< Flag indicating whether the transaction was passed.
+
+    for (uint8_t i = 0; i < this->queueCount; i++)
+    {
+        uint8_t next = slot + 1;     //*< The entry behind it, around the ring.
+        if (next >= TWI_QUEUE_SIZE)
+            next = 0;
+        if (this->queue[slot] == transaction)  //*< Found, the entries behind it move up.
+            found = 1;
+        if (found && i + 1 < this->queueCount)
+            this->queue[slot] = this->queue[next];
+        slot = next;
+    }
+
+    if (found)
+        this->queueCount--;  //*< Account for the removed entry.
+
+    return (found);
+}
+
+
+#ifndef TWI_LEAN
+/**
+ * @brief Prepares the transaction reading the current scan entry.
+ * 
+ * @return Pointer to the scan transaction.
+ */
+template <class REGISTERS, uint16_t BUFFER_SIZE>
+TWI_Transaction* __TWI__<REGISTERS, BUFFER_SIZE>::scanEntry(void)
+{
+    const TWI_ScanEntry* entry = &this->scanList[this->scanIndex];  //*< The register block to read.
+
+    this->scanTransfer.address = entry->address;                   //*< Address its device...
+    this->scanTransfer.txData = &entry->reg;                       //*< ...write the register...
+    this->scanTransfer.txLength = 1;
+    this->scanTransfer.rxData = this->scanBack + entry->offset;    //*< ...and read into the back snapshot.
+    this->scanTransfer.rxLength = entry->length;
+
+    return (&this->scanTransfer);
+}
+#endif
+
+
+/**
+ * @brief Ends the current master transaction on the bus once all bytes were transferred.
+ * 
+ * Depending on the `sendStop` flag this function either sends a STOP condition or a 
+ * repeated START that keeps the bus for the next call, and then finishes the transaction.
+ */
+template <class REGISTERS, uint16_t BUFFER_SIZE>
+void __TWI__<REGISTERS, BUFFER_SIZE>::finish(void)
+{
+    if (this->sendStop)  //*< If a stop condition should be sent
+        this->stop();    //*< Send a stop condition.
+    else                 //*< If the bus should be kept
+    {
+        this->inRepStart = 1;               //*< Mark that we are in repeated start.
+        this->control(TWI_SEND_REP_START);  //*< Send a repeated start condition.
+    }
+
+    this->complete();  //*< Set state to ready for more transactions.
+}
+
+
+/**
+ * @brief Prepares a master transaction so the ISR can run it.
+ * 
+ * A transaction with bytes to transmit (or with nothing at all, as used for probing 
+ * an address) is run in master transmitter mode, otherwise in master receiver mode.
+ * 
+ * @param transaction Pointer to the transaction to prepare.
+ * @param sendStop A flag that determines whether the transaction ends with a STOP 
+ *                 condition (`1`) or a repeated START condition (`0`).
+ */
+template <class REGISTERS, uint16_t BUFFER_SIZE>
+void __TWI__<REGISTERS, BUFFER_SIZE>::load(TWI_Transaction* transaction, const uint8_t sendStop)
+{
+    transaction->done = 0;   //*< The transaction is now pending.
+    transaction->count = 0;  //*< Nothing was transferred yet.
+
+    const TWI_Clock* clock = (transaction->clock != NULL) ? transaction->clock : &this->clock;  //*< The clock profile of the device.
+    REGISTERS::twbr() = clock->twbr;  //*< Switch the bit rate before the START...
+    REGISTERS::twsr() = clock->twps;  //*< ...including the prescaler.
+
+    this->transaction = transaction;  //*< This is the transaction on the bus.
+    this->sendStop = sendStop;        //*< Set the sendStop flag to the provided value.
+    this->index = 0;                  //*< Start with the first byte.
+
+    this->polls = transaction->ackPolls;  //*< Retry a refused address this often.
+    this->retries = transaction->retries;  //*< Repeat a refused transaction this often.
+
+    if (transaction->txLength || transaction->txNextLength || !transaction->rxLength)  //*< Something to transmit, or an address probe
+    {
+        this->state = TWI_MTX;                                   //*< Set the state to master transmit mode.
+        this->address = (transaction->address << 1) | TW_WRITE;  //*< Prepare the address for writing.
+        this->txData = transaction->txData;                      //*< Transmit from the caller's bytes...
+        this->txNext = transaction->txNext;                      //*< ...continued from the second buffer.
+        this->split = transaction->txLength;                     //*< Where the second buffer starts.
+        this->rxData = transaction->rxData;                      //*< Receive into the caller's memory after the repeated START, if any.
+        this->length = transaction->txLength + transaction->txNextLength;  //*< Transmit all of them.
+        this->smbus = transaction->smbus;                        //*< The SMBus handling of the transaction...
+        if ((this->smbus & TWI_SMBUS_PEC) && !transaction->rxLength)  //*< ...a plain write closes with its PEC.
+            this->smbus |= TWI_SMBUS_APPEND;
+    }
+    else
+    {
+        this->state = TWI_MRX;                                  //*< Set the state to master receiver mode.
+        this->address = (transaction->address << 1) | TW_READ;  //*< Prepare the address for reading.
+        this->rxData = transaction->rxData;                     //*< Receive into the caller's memory.
+        this->smbus = transaction->smbus;                       //*< The SMBus handling of the transaction.
+        this->length = transaction->rxLength + (this->smbus & TWI_SMBUS_PEC) + ((this->smbus & TWI_SMBUS_BLOCK) >> 1);  //*< Receive the requested bytes, plus the PEC and block count.
+    }
+
+    this->crc = this->smbus ? crc8(0, this->address) : 0;  //*< The PEC covers the address byte as well.
+}
+
+
+/**
+ * @brief Turns the current master transaction around into its read part.
+ * 
+ * Called by the ISR once the last byte of a transaction that also reads was ACKed. 
+ * It switches to master receiver mode and issues a repeated START with the interrupt 
+ * enabled, so the `TW_REP_START` case sends SLA+R without returning to the foreground.
+ */
+template <class REGISTERS, uint16_t BUFFER_SIZE>
+void __TWI__<REGISTERS, BUFFER_SIZE>::restart(void)
+{
+    this->state = TWI_MRX;                          //*< Set the state to master receiver mode.
+    this->address |= TW_READ;                       //*< Address the same device for reading.
+    this->length = this->transaction->rxLength + (this->smbus & TWI_SMBUS_PEC) + ((this->smbus & TWI_SMBUS_BLOCK) >> 1);  //*< Receive the requested bytes, plus the PEC and block count.
+    this->index = 0;                                //*< Start with the first byte.
+    this->control(TWI_SEND_RESTART);           //*< Send the repeated start condition.
+    if (this->smbus)                           //*< The PEC covers the read address too...
+        this->crc = crc8(this->crc, this->address);  //*< ...computed while the condition is generated.
+}
+
+
+/**
+ * @brief Puts the prepared buffered transfer on the bus once it is ready.
+ * 
+ * The caller found the bus ready with `idle()`, but since then a timer calling `scan()` or 
+ * a callback calling `enqueue()` may have taken it. The state is checked again with 
+ * interrupts disabled; if the bus was taken, the function waits for it once more.
+ * 
+ * @param sendStop A flag that determines whether the transfer ends with a STOP 
+ *                 condition (`1`) or a repeated START condition (`0`).
+ * 
+ * @return `1` if the transfer is in flight, `0` if the bus did not become ready in time.
+ */
+template <class REGISTERS, uint16_t BUFFER_SIZE>
+const uint8_t __TWI__<REGISTERS, BUFFER_SIZE>::submit(const uint8_t sendStop)
+{
+    uint8_t launched = 0;  //*< Flag indicating whether the transfer is on the bus.
+
+    while (1)
+    {
+        ATOMIC_BLOCK(ATOMIC_RESTORESTATE)  //*< Prevent the ISR from seeing a half prepared transaction...
+        {
+            if (this->state == TWI_READY)  //*< ...or from taking the bus in between.
+            {
+                this->load(&this->transfer, sendStop);  //*< Prepare the transfer for the ISR.
+                this->launch();                         //*< Put it on the bus.
+                launched = 1;
+            }
+        }
+
+        if (launched)
+            return (1);
+
+        if (!this->idle())  //*< Taken meanwhile, wait again; give up if the bus made no progress.
+            return (0);
+    }
+}
+
+
+/**
+ * @brief Puts the prepared master transaction on the bus.
  * 
- * @note This function is typically called to terminate a communication session.
+ * If a previous transaction kept the bus with a repeated START, the START has already 
+ * been issued, without TWIE. It may still be on the wire (right after the ISR issued it, 
+ * TWDR can't be written yet), so only TWIE is set: its `TW_REP_START` interrupt, pending 
+ * or already raised, sends the address through `onStart()`. Otherwise a START condition 
+ * is issued, following the STOP of the previous transaction if that is still on the wire.
  */
-void __TWI__::stop(void)
+template <class REGISTERS, uint16_t BUFFER_SIZE>
+void __TWI__<REGISTERS, BUFFER_SIZE>::launch(void)
 {
-    *this->twcr = TWI_SEND_STOP;        //*< Initiate a stop condition.
-    while(*this->twcr & (1 << TWSTO));  //*< Wait until stop condition is finished.
-    this->state = TWI_READY;            //*< Mark the bus as ready for future communication.
+    // If we're in a repeated start, we've already sent the START in the ISR. Don't do it again.
+    if (this->inRepStart)  //*< Check if we are in a repeated start condition.
+    {
+        this->inRepStart = 0;                //*< Reset the repeated start flag.
+        this->control(TWI_AWAIT_REP_START);  //*< Leave TWINT alone, let its interrupt address the slave.
+    }
+    else if (REGISTERS::twcr() & (1 << TWSTO))  //*< The last STOP is still on the wire...
+        this->control(TWI_SEND_STOP_START);    //*< ...the START follows it.
+    else
+        this->control(TWI_SEND_START);  //*< Send the START condition.
 }
 
+
+#ifdef TWI_SHARED_BUFFER
+/**
+ * @brief The buffer of all instances, see `TWI_SHARED_BUFFER`.
+ */
+volatile uint8_t TWI_SharedBuffer[TWI_BUFFER_SIZE];
+
+template <class REGISTERS, uint16_t BUFFER_SIZE>
+constexpr volatile uint8_t* __TWI__<REGISTERS, BUFFER_SIZE>::buffer;
+#endif
+
+
+/**
+ * @brief Explicit instantiations of the TWI class for every available peripheral.
+ */
+#if defined(__AVR_ATmega328__)  || \
+    defined(__AVR_ATmega328P__) || \
+    defined(__AVR_ATmega328PB__)
+    template class __TWI__<TWI0_Registers, TWI0_BUFFER_SIZE>;
+#endif
+
+#if defined(__AVR_ATmega328PB__)
+    template class __TWI__<TWI1_Registers, TWI1_BUFFER_SIZE>;
+#endif
+
+#if defined(TWI_HOST)
+    template class __TWI__<TWI_HostRegisters, TWI0_BUFFER_SIZE>;
+#endif
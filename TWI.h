@@ -4,12 +4,21 @@
 /* Dependecies */
 #include <stdio.h>
 #include <stdint.h>
+#if defined(TWI_HOST)
+#include "TWI_Host.h"
+#else
 #include <avr/interrupt.h>
+#include <avr/pgmspace.h>
+#include <avr/sleep.h>
 #include <util/twi.h>
 #include <util/atomic.h>
 #include <util/delay.h>
+#endif
 
 #define TWI_DEFAULT_FREQUENCY (const uint32_t)400000
+#define TWI_STANDARD_MODE     (const uint32_t)100000
+#define TWI_FAST_MODE         (const uint32_t)400000
+#define TWI_FAST_MODE_PLUS    (const uint32_t)1000000
 #define TWI_ROLE_MASTER       (const uint8_t)0
 #define TWI_ROLE_SLAVE        (const uint8_t)1
 #define TWI_READY             (const uint8_t)0
@@ -17,14 +26,335 @@
 #define TWI_MTX               (const uint8_t)2
 #define TWI_SRX               (const uint8_t)3
 #define TWI_STX               (const uint8_t)4
+#ifndef TWI_BUFFER_SIZE
 #define TWI_BUFFER_SIZE       (const uint8_t)32
+#endif
+#ifndef TWI0_BUFFER_SIZE
+#define TWI0_BUFFER_SIZE      TWI_BUFFER_SIZE
+#endif
+#ifndef TWI1_BUFFER_SIZE
+#define TWI1_BUFFER_SIZE      TWI_BUFFER_SIZE
+#endif
+#ifndef TWI_FRAME_SIZE
+#define TWI_FRAME_SIZE        (const uint8_t)32
+#endif
+#ifndef TWI_QUEUE_SIZE
+#define TWI_QUEUE_SIZE        (const uint8_t)4
+#endif
 #define TWI_BEGIN             ((1 << TWEN) | (1 << TWIE) | (1 << TWEA))
 #define TWI_SEND_ACK          ((1 << TWEN) | (1 << TWIE) | (1 << TWINT) | (1 << TWEA))
 #define TWI_SEND_NACK         ((1 << TWEN) | (1 << TWIE) | (1 << TWINT))
 #define TWI_SEND_START        ((1 << TWEN) | (1 << TWIE) | (1 << TWINT) | (1 << TWEA) | (1 << TWSTA))
 #define TWI_SEND_REP_START    ((1 << TWEN) | (1 << TWINT) | (1 << TWSTA))
+#define TWI_AWAIT_REP_START   ((1 << TWEN) | (1 << TWIE) | (1 << TWSTA))
+#define TWI_SEND_RESTART      ((1 << TWEN) | (1 << TWIE) | (1 << TWINT) | (1 << TWEA) | (1 << TWSTA))
 #define TWI_SEND_STOP         ((1 << TWEN) | (1 << TWIE) | (1 << TWINT) | (1 << TWEA) | (1 << TWSTO))
+#define TWI_SEND_STOP_START   ((1 << TWEN) | (1 << TWIE) | (1 << TWINT) | (1 << TWEA) | (1 << TWSTO) | (1 << TWSTA))
 #define TWI_END               (const uint8_t)0
+#ifndef TWI_DEFAULT_TIMEOUT
+#define TWI_DEFAULT_TIMEOUT   (const uint16_t)25000
+#endif
+#ifndef TWI_STOP_TIMEOUT
+#define TWI_STOP_TIMEOUT      (const uint8_t)100
+#endif
+#define TWI_ERROR_TIMEOUT     (const uint8_t)0x01
+#define TWI_ERROR_BUS_STUCK   (const uint8_t)0x02
+#define TWI_ERROR_ABORTED     (const uint8_t)0x03
+#define TWI_ERROR_PEC         (const uint8_t)0x04
+#define TWI_ERROR_TRUNCATED   (const uint8_t)0x05
+#define TWI_RESULT_OK         (const uint8_t)0
+#define TWI_RESULT_ADDRESS_NACK (const uint8_t)1
+#define TWI_RESULT_DATA_NACK  (const uint8_t)2
+#define TWI_RESULT_ARBITRATION_LOST (const uint8_t)3
+#define TWI_RESULT_ERROR      (const uint8_t)4
+#define TWI_SMBUS_PEC         (const uint8_t)0x01
+#define TWI_SMBUS_BLOCK       (const uint8_t)0x02
+#define TWI_SMBUS_TRUNCATED   (const uint8_t)0x40
+#define TWI_SMBUS_APPEND      (const uint8_t)0x80
+#define TWI_SMBUS_POLYNOMIAL  (const uint8_t)0x07
+#define TWI_TASK_READY        (const uint8_t)0
+#define TWI_TASK_PENDING      (const uint8_t)1
+#define TWI_TASK_DONE         (const uint8_t)2
+#define TWI_TASK_ERROR        (const uint8_t)3
+#ifdef TWI_POLLING
+#define TWI_CONTROL_MASK      (const uint8_t)~(1 << TWIE)
+#else
+#define TWI_CONTROL_MASK      (const uint8_t)0xFF
+#endif
+#ifdef TWI_SLEEP
+#define TWI_SLEEP_WAITS       (const uint8_t)1
+#else
+#define TWI_SLEEP_WAITS       (const uint8_t)0
+#endif
+#ifndef TWI_SLEEP_TICK
+#define TWI_SLEEP_TICK        (const uint16_t)1024
+#endif
+#ifdef TWI_INSTRUMENTATION
+#ifndef TWI_TRACE_SIZE
+#define TWI_TRACE_SIZE        (const uint8_t)16
+#endif
+#ifndef TWI_TRACE_TIMESTAMP
+#define TWI_TRACE_TIMESTAMP() (TCNT1)
+#endif
+#endif
+
+/**
+ * @brief Bit rate register settings of the TWI clock.
+ *
+ * The SCL frequency is `F_CPU / (16 + 2 * twbr * 4^twps)`. Use `TWI_BitRate` to compute 
+ * the pair at compile time.
+ */
+typedef struct TWI_Clock
+{
+    uint8_t twbr;  //< The value of the TWI bit rate register.
+    uint8_t twps;  //< The TWI prescaler bits of the status register.
+} TWI_Clock;
+
+/**
+ * @brief Computes the TWI clock settings for a bit rate at compile time.
+ *
+ * The smallest prescaler that fits the divider into TWBR is chosen, and TWBR is rounded 
+ * up so the resulting SCL frequency never exceeds the requested one. A rate that cannot 
+ * be reached with the given CPU clock is a compile-time error.
+ *
+ * @code
+ * TWI0.begin(TWI_BitRate<TWI_FAST_MODE_PLUS>::clock());
+ * @endcode
+ *
+ * @tparam FREQUENCY The desired SCL frequency in Hz.
+ * @tparam CPU The CPU clock in Hz, `F_CPU` by default.
+ */
+template <uint32_t FREQUENCY, uint32_t CPU = F_CPU>
+struct TWI_BitRate
+{
+    static_assert(FREQUENCY > 0, "The TWI frequency must not be zero");
+    static_assert((CPU + FREQUENCY - 1) / FREQUENCY >= 16, "The TWI frequency is too high for this CPU clock");
+
+    static constexpr uint32_t STEPS     = ((CPU + FREQUENCY - 1) / FREQUENCY - 16 + 1) / 2;  //< The required `twbr * 4^twps`, rounded up.
+    static constexpr uint8_t  PRESCALER = (STEPS <= 255UL) ? 0 : (STEPS <= 1020UL) ? 1 : (STEPS <= 4080UL) ? 2 : 3;  //< The smallest prescaler that fits.
+    static constexpr uint32_t BIT_RATE  = (STEPS + (1UL << (2 * PRESCALER)) - 1) >> (2 * PRESCALER);  //< The bit rate register value, rounded up.
+
+    static_assert(BIT_RATE <= 255, "The TWI frequency is too low for this CPU clock");
+
+    static constexpr TWI_Clock clock(void) { return (TWI_Clock{(uint8_t)BIT_RATE, PRESCALER}); }  //< The resulting clock settings.
+};
+
+/**
+ * @brief Descriptor of a single master transaction.
+ *
+ * A transaction writes `txLength` bytes from `txData` and then reads `rxLength` bytes 
+ * into `rxData`. When both are given, the ISR goes from the last written byte straight 
+ * to a repeated START and the read, as used for reading device registers. Either part 
+ * may be empty. The buffers are owned by the caller and must stay valid until `done` 
+ * is set by the ISR. `status` and `count` report the final TWI status and the number 
+ * of bytes actually transferred (received, if the transaction reads).
+ *
+ * `clock` selects a per-device clock profile; the ISR switches TWBR/TWPS before the 
+ * transaction's START, so one slow device doesn't hold the whole bus at its rate. 
+ * `NULL` runs the transaction at the bus clock.
+ *
+ * `txNext` continues the written bytes from a second buffer, e.g. a memory address 
+ * header followed by the caller's data, without copying them together. `ackPolls` 
+ * retries an address the device refused (STOP, then START again) up to that many 
+ * times, to wait for the end of an EEPROM write cycle on the bus instead of with a 
+ * fixed delay.
+ *
+ * `smbus` turns on SMBus handling: with `TWI_SMBUS_PEC` a Packet Error Code is appended 
+ * to a write or checked at the end of a read (`TWI_ERROR_PEC` on mismatch); with 
+ * `TWI_SMBUS_BLOCK` the first byte read is the block count, which sizes the rest of the 
+ * read on the fly and is not stored (`count` reports the data bytes). A block larger than 
+ * `rxLength` is cut off with a NACK after the bytes that fit and ends with 
+ * `TWI_ERROR_TRUNCATED`; its PEC is never read.
+ *
+ * `retries` repeats a transaction the device refused (address or data NACK) up to that 
+ * many times, after a STOP and `backoff` microseconds of silence, counted by `tick()`. 
+ * A retry starts over, unless `resume` is set and a data byte was refused: then it 
+ * continues at that byte, sending nothing that was already acknowledged. SMBus 
+ * transactions ignore `resume` and start over, the PEC covers the whole transaction.
+ */
+typedef struct TWI_Transaction
+{
+    uint8_t address;          //< The 7-bit address of the slave device.
+    const uint8_t* txData;    //< The bytes to transmit.
+    uint16_t txLength;        //< The number of bytes to transmit.
+    uint8_t* rxData;          //< The destination of the received bytes.
+    uint16_t rxLength;        //< The number of bytes to receive.
+    const TWI_Clock* clock;   //< The clock profile of the device, NULL for the bus clock.
+    volatile uint8_t status;  //< The final TWI status of the transaction.
+    volatile uint16_t count;  //< The number of bytes transferred.
+    volatile uint8_t done;    //< Flag set by the ISR once the transaction has finished.
+    const uint8_t* txNext;    //< The bytes transmitted after `txData`, NULL if none.
+    uint16_t txNextLength;    //< The number of bytes to transmit from `txNext`.
+    uint16_t ackPolls;        //< The number of times a refused address is retried, `0` to fail at once.
+    uint8_t smbus;            //< The SMBus flags, `TWI_SMBUS_PEC` and `TWI_SMBUS_BLOCK`, `0` for plain I2C.
+    uint8_t retries;          //< The number of times a refused transaction is repeated, `0` to fail at once.
+    uint16_t backoff;         //< The silence on the bus before every retry in microseconds, `0` to retry at once.
+    uint8_t resume;           //< Non-zero to continue a retried write at the refused byte instead of starting over.
+} TWI_Transaction;
+
+/**
+ * @brief A finished transaction with every other field cleared.
+ *
+ * The initial value of the descriptors the library owns, so they read as done until 
+ * first used. Kept in one place, the aggregate lists every field.
+ */
+#define TWI_TRANSACTION_IDLE  TWI_Transaction{0, NULL, 0, NULL, 0, NULL, 0, 0, 1, NULL, 0, 0, 0, 0, 0, 0}
+
+/**
+ * @brief One register block read by the autonomous scan.
+ *
+ * The ISR writes `reg` to the device, then reads `length` bytes into the snapshot at 
+ * `offset`.
+ */
+typedef struct TWI_ScanEntry
+{
+    uint8_t address;  //< The 7-bit address of the device.
+    uint8_t reg;      //< The register to read from.
+    uint8_t length;   //< The number of bytes to read.
+    uint8_t offset;   //< The position of the bytes in the snapshot.
+} TWI_ScanEntry;
+
+/**
+ * @brief A master transaction advanced cooperatively from the main loop.
+ *
+ * `poll()` moves the task from `TWI_TASK_READY` over `TWI_TASK_PENDING` to `TWI_TASK_DONE` 
+ * or `TWI_TASK_ERROR` without ever blocking. Set `state` back to `TWI_TASK_READY` to run 
+ * the transaction again.
+ *
+ * @code
+ * static uint8_t sample[6];
+ * static TWI_Task read = {{0x1E, NULL, 0, sample, sizeof(sample)}};
+ * @endcode
+ */
+typedef struct TWI_Task
+{
+    TWI_Transaction transaction;  //< The transaction to run, its `status` and `count` report the outcome.
+    uint8_t state;                //< The progress of the task, `TWI_TASK_READY` to start it.
+} TWI_Task;
+
+/**
+ * @brief A frame received in slave mode.
+ *
+ * Frames are stored in a caller-owned ring registered with `setRxRing()`. The ISR 
+ * fills one frame per write from a master, the application drains them later.
+ */
+typedef struct TWI_Frame
+{
+    uint8_t address;               //< The 7-bit slave address the master wrote to.
+    uint8_t length;                //< The number of bytes received.
+    uint8_t data[TWI_FRAME_SIZE];  //< The received bytes.
+} TWI_Frame;
+
+#ifdef TWI_INSTRUMENTATION
+/**
+ * @brief A TWI status code seen by the ISR and the time it was seen.
+ */
+typedef struct TWI_TraceEntry
+{
+    uint8_t status;  //< The TWSR status code with the prescaler bits masked out.
+    uint16_t time;   //< The value of `TWI_TRACE_TIMESTAMP()` when the ISR ran.
+} TWI_TraceEntry;
+
+/**
+ * @brief Counters and recent history of a TWI bus.
+ *
+ * Only available when `TWI_INSTRUMENTATION` is defined before including `TWI.h`; without 
+ * it none of the counting code is compiled in. Read it with `snapshot()`.
+ */
+typedef struct TWI_Stats
+{
+    uint32_t txBytes;          //< Data bytes sent, as master or slave.
+    uint32_t rxBytes;          //< Data bytes received, as master or slave.
+    uint16_t slaNacks;         //< Slave addresses that were not acknowledged.
+    uint16_t dataNacks;        //< Data bytes the slave did not acknowledge as master transmitter.
+    uint16_t arbitrationLost;  //< Arbitrations lost to another master.
+    uint16_t busErrors;        //< Illegal START or STOP conditions.
+    uint16_t retries;          //< Transactions repeated after a NACK.
+    uint32_t waitSpins;        //< Iterations of the blocking waits, about a microsecond each while the bus is silent.
+    uint16_t isrTicks;         //< The longest ISR run in `TWI_TRACE_TIMESTAMP()` ticks.
+    uint16_t transitionTicks[32]; //< The longest ISR run per transition, indexed by `status >> 3` like the dispatch table.
+    uint8_t traceHead;         //< The index of the oldest trace entry, the next one to be overwritten.
+    TWI_TraceEntry trace[TWI_TRACE_SIZE]; //< The most recent status codes, oldest at `traceHead`.
+} TWI_Stats;
+#endif
+
+/**
+ * @brief Register sets of the TWI peripherals.
+ *
+ * Each traits type binds one TWI peripheral to its fixed I/O addresses. The accessors 
+ * are resolved at compile time, so every register access in `__TWI__` compiles down to 
+ * a direct `lds`/`sts` on the register instead of a load through a stored pointer. The 
+ * port and pins of SCL/SDA are used to clock a stuck bus free.
+ */
+#if defined(__AVR_ATmega328__)  || \
+    defined(__AVR_ATmega328P__)
+    struct TWI0_Registers
+    {
+        static volatile uint8_t& twbr (void) { return (TWBR);  } //< The TWI bit rate register.
+        static volatile uint8_t& twsr (void) { return (TWSR);  } //< The TWI status register.
+        static volatile uint8_t& twar (void) { return (TWAR);  } //< The TWI address register.
+        static volatile uint8_t& twdr (void) { return (TWDR);  } //< The TWI data register.
+        static volatile uint8_t& twcr (void) { return (TWCR);  } //< The TWI control register.
+        static volatile uint8_t& twamr(void) { return (TWAMR); } //< The TWI address mask register.
+        static volatile uint8_t& port (void) { return (PORTC); } //< The output register of the SCL/SDA pins.
+        static volatile uint8_t& ddr  (void) { return (DDRC);  } //< The direction register of the SCL/SDA pins.
+        static volatile uint8_t& pin  (void) { return (PINC);  } //< The input register of the SCL/SDA pins.
+        static const uint8_t SCL = PC5;                          //< The SCL pin.
+        static const uint8_t SDA = PC4;                          //< The SDA pin.
+    };
+#elif defined(__AVR_ATmega328PB__)
+    struct TWI0_Registers
+    {
+        static volatile uint8_t& twbr (void) { return (TWBR0);  } //< The TWI0 bit rate register.
+        static volatile uint8_t& twsr (void) { return (TWSR0);  } //< The TWI0 status register.
+        static volatile uint8_t& twar (void) { return (TWAR0);  } //< The TWI0 address register.
+        static volatile uint8_t& twdr (void) { return (TWDR0);  } //< The TWI0 data register.
+        static volatile uint8_t& twcr (void) { return (TWCR0);  } //< The TWI0 control register.
+        static volatile uint8_t& twamr(void) { return (TWAMR0); } //< The TWI0 address mask register.
+        static volatile uint8_t& port (void) { return (PORTC);  } //< The output register of the SCL0/SDA0 pins.
+        static volatile uint8_t& ddr  (void) { return (DDRC);   } //< The direction register of the SCL0/SDA0 pins.
+        static volatile uint8_t& pin  (void) { return (PINC);   } //< The input register of the SCL0/SDA0 pins.
+        static const uint8_t SCL = PC5;                           //< The SCL0 pin.
+        static const uint8_t SDA = PC4;                           //< The SDA0 pin.
+    };
+
+    struct TWI1_Registers
+    {
+        static volatile uint8_t& twbr (void) { return (TWBR1);  } //< The TWI1 bit rate register.
+        static volatile uint8_t& twsr (void) { return (TWSR1);  } //< The TWI1 status register.
+        static volatile uint8_t& twar (void) { return (TWAR1);  } //< The TWI1 address register.
+        static volatile uint8_t& twdr (void) { return (TWDR1);  } //< The TWI1 data register.
+        static volatile uint8_t& twcr (void) { return (TWCR1);  } //< The TWI1 control register.
+        static volatile uint8_t& twamr(void) { return (TWAMR1); } //< The TWI1 address mask register.
+        static volatile uint8_t& port (void) { return (PORTE);  } //< The output register of the SCL1/SDA1 pins.
+        static volatile uint8_t& ddr  (void) { return (DDRE);   } //< The direction register of the SCL1/SDA1 pins.
+        static volatile uint8_t& pin  (void) { return (PINE);   } //< The input register of the SCL1/SDA1 pins.
+        static const uint8_t SCL = PE1;                           //< The SCL1 pin.
+        static const uint8_t SDA = PE0;                           //< The SDA1 pin.
+    };
+#endif
+
+/**
+ * @brief Selects the type of buffer lengths and indexes.
+ *
+ * Buffers of up to 255 bytes keep 8-bit lengths, larger buffers switch to 16-bit 
+ * lengths so a single transaction can fill them.
+ */
+template <bool WIDE>
+struct TWI_Length
+{
+    typedef uint8_t type;
+};
+
+template <>
+struct TWI_Length<true>
+{
+    typedef uint16_t type;
+};
+
+#ifdef TWI_SHARED_BUFFER
+extern volatile uint8_t TWI_SharedBuffer[TWI_BUFFER_SIZE];
+#endif
 
 /**
  * @brief Class for managing TWI (Two-Wire Interface) communication.
@@ -33,72 +363,318 @@
  * of TWI (I2C) communication, including both master and slave roles. It provides 
  * methods for managing the frequency, transmission, reception of data, and 
  * callback functions for handling the received and transmitted data.
+ *
+ * @tparam REGISTERS The register set of the TWI peripheral (e.g. `TWI0_Registers`). 
+ *                   The registers are bound at compile time, so an instance holds no 
+ *                   register pointers and is built by a `constexpr` constructor 
+ *                   without any static initialization code.
+ * @tparam BUFFER_SIZE The capacity of the internal buffer in bytes. Capacities above 
+ *                     255 bytes switch the buffer lengths to 16 bits.
+ *
+ * Two compile-time options trim the RAM of every instance. `TWI_LEAN` packs the flags 
+ * `began` and `role` into one byte and `sendStop`, `inRepStart` and `joined` into another, 
+ * so three bytes hold what took six; the latter three are only written by the ISR, inside atomic 
+ * sections, or before the TWI is enabled. `state` keeps a byte of its own, as the 
+ * foreground writes it with interrupts enabled. It also compiles out the scan and the 
+ * receive ring with its frames; the transaction queue stays, as the tasks, `TWI_SMBus` 
+ * and `TWI_Memory` build on it, but `TWI_QUEUE_SIZE` shrinks it. `TWI_SHARED_BUFFER` 
+ * makes all instances use the one `TWI_SharedBuffer` of `TWI_BUFFER_SIZE` bytes instead of a buffer each; the 
+ * application must make sure the buffered calls of the instances never overlap, e.g. one 
+ * instance is master only using caller-owned transactions and the other is slave only.
  */
+template <class REGISTERS, uint16_t BUFFER_SIZE = TWI_BUFFER_SIZE>
 class __TWI__
 {
+    static_assert(BUFFER_SIZE > 0, "The TWI buffer needs room for at least one byte");
+
     public:
-        __TWI__(volatile uint8_t* twbr, volatile uint8_t* twsr, volatile uint8_t* twar, volatile uint8_t* twdr, volatile uint8_t* twcr, volatile uint8_t* twamr);
-        ~__TWI__();
+        typedef typename TWI_Length<(BUFFER_SIZE > 255)>::type length_t; //< The type of buffer lengths and indexes.
+
+        /**
+         * @brief Callbacks of one virtual slave device answering at its own address.
+         */
+        typedef struct SlaveHandler
+        {
+            uint8_t address;                          //< The 7-bit address the handler answers.
+            void (*rxCallback)(const length_t size);  //< The callback function for receiving data.
+            void (*txCallback)(void);                 //< The callback function for transmitting data.
+        } SlaveHandler;
+
+        constexpr __TWI__() :
+            began(0), role(TWI_ROLE_MASTER), clock{0, 0}, state(TWI_READY), sendStop(1), inRepStart(0), joined(0),
+            status(0), address(0), bufferIndex(0), bufferSize(0),
+#ifndef TWI_SHARED_BUFFER
+            buffer(),
+#endif
+            transfer(TWI_TRANSACTION_IDLE), transaction(NULL), txData(NULL), rxData(NULL), length(0), index(0), txNext(NULL), split(0), polls(0), smbus(0), crc(0), pec(0), pecValid(0), retries(0), backoff(0),
+            queue(), queueHead(0), queueCount(0),
+#ifndef TWI_LEAN
+            ring(NULL), ringSize(0), ringHead(0), ringTail(0), frame(NULL),
+            scanList(NULL), scanCount(0), scanIndex(0), scanFailed(0), scanReady(0), scanFront(NULL), scanBack(NULL),
+            scanTransfer(TWI_TRANSACTION_IDLE),
+#endif
+            registerMap(NULL), registerCount(0), readOnlyMask(NULL), writeOnlyMask(NULL), registerPointer(0), registerPending(0),
+            handlers(NULL), handlerCount(0), handler(NULL), matched(0),
+            timeout(TWI_DEFAULT_TIMEOUT), activity(0), controlMask(TWI_CONTROL_MASK), sleeping(TWI_SLEEP_WAITS),
+#ifdef TWI_INSTRUMENTATION
+            stats(),
+#endif
+            rxCallback(NULL), txCallback(NULL), doneCallback(NULL),
+#ifndef TWI_LEAN
+            frameCallback(NULL),
+#endif
+            txProducer(NULL) {}
 
         const uint8_t begin       (const uint32_t frequency);
         const uint8_t begin       (void);
         const uint8_t begin       (const uint8_t address);
+        const uint8_t begin       (const uint8_t address, const uint8_t mask);
+        const uint8_t begin       (const TWI_Clock clock);
         const uint8_t setFrequency(const uint32_t frequency);
+        const uint8_t setClock    (const TWI_Clock clock);
 
         const uint8_t beginTransmission(const uint8_t address);
         const uint8_t write            (const uint8_t byte);
-        const uint8_t write            (const uint8_t* bytes, const uint8_t size);
-        const uint8_t write            (const void* data, const uint8_t size);
+        const uint8_t write            (const uint8_t* bytes, const length_t size);
+        const uint8_t write            (const void* data, const length_t size);
         const uint8_t endTransmission  (const uint8_t sendStop);
         const uint8_t endTransmission  (void);
+        const uint8_t startTransmission(const uint8_t sendStop);
+        const uint8_t startTransmission(void);
+        const uint8_t startTransmission(const uint8_t address, const void* data, const uint16_t size, const uint8_t sendStop);
+        const uint8_t startTransmission(const uint8_t address, const void* data, const uint16_t size);
+        const uint8_t transmit         (const uint8_t address, const void* data, const uint16_t size, const uint8_t sendStop);
+        const uint8_t transmit         (const uint8_t address, const void* data, const uint16_t size);
+
+        const length_t requestFrom(const uint8_t address, length_t quantity, const uint8_t sendStop);
+        const length_t requestFrom(const uint8_t address, length_t quantity);
+        const uint8_t startRequest(const uint8_t address, const length_t quantity, const uint8_t sendStop);
+        const uint8_t startRequest(const uint8_t address, const length_t quantity);
+        const uint16_t requestFrom (const uint8_t address, void* destination, const uint16_t length, const uint8_t sendStop);
+        const uint16_t requestFrom (const uint8_t address, void* destination, const uint16_t length);
+        const uint8_t startRequest(const uint8_t address, void* destination, const uint16_t length, const uint8_t sendStop);
+        const uint8_t startRequest(const uint8_t address, void* destination, const uint16_t length);
+        const uint16_t writeThenRead     (const uint8_t address, const void* source, const uint16_t size, void* destination, const uint16_t length);
+        const uint8_t startWriteThenRead(const uint8_t address, const void* source, const uint16_t size, void* destination, const uint16_t length);
+        const uint16_t received   (void);
+        const uint8_t isBusy     (void);
+        const uint8_t poll       (void);
+        const uint8_t setPolling (const uint8_t enabled);
+        void setSleep            (const uint8_t enabled);
+        const uint8_t powerDown  (void);
+        const uint8_t getStatus  (void);
 
-        const uint8_t requestFrom(const uint8_t address, uint8_t quantity, const uint8_t sendStop);
-        const uint8_t requestFrom(const uint8_t address, uint8_t quantity);
-        const uint8_t available  (void);
+        void setTimeout       (const uint16_t microseconds);
+        const uint16_t getTimeout(void);
+        const uint8_t wait    (TWI_Transaction* transaction, const uint16_t timeout);
+        const uint8_t recover (void);
+        void tick             (const uint16_t microseconds);
+        static const uint8_t result(const uint8_t status);
+
+        const uint8_t enqueue(TWI_Transaction* transaction);
+        const uint8_t queued (void);
+        const uint8_t poll   (TWI_Task* task);
+
+#ifndef TWI_LEAN
+        const uint8_t setScan  (const TWI_ScanEntry* entries, const uint8_t count, uint8_t* front, uint8_t* back);
+        const uint8_t scan     (void);
+        const uint8_t* takeScan(uint8_t* failed);
+#endif
+        const length_t available (void);
         const uint8_t read       (void);
         const uint8_t end        (void);
 
-        void setRxCallback(void (*function)(const uint8_t size));
+        void setRxCallback(void (*function)(const length_t size));
         void setTxCallback(void (*function)(void));
+        void setTxProducer(uint8_t (*function)(void));
+        void setPec       (const uint8_t enabled);
+        const uint8_t checkPec(void);
+        void setDoneCallback(void (*function)(const uint8_t status));
+
+#ifndef TWI_LEAN
+        const uint8_t setRxRing       (TWI_Frame* frames, const uint8_t count);
+        const uint8_t frames          (void);
+        const TWI_Frame* peekFrame    (void);
+        void releaseFrame             (void);
+        const uint8_t dispatch        (void);
+        void setFrameCallback         (void (*function)(const uint8_t* data, const uint8_t length));
+#endif
+
+        const uint8_t setRegisterMap(volatile uint8_t* registers, const uint16_t size, const uint8_t* readOnly, const uint8_t* writeOnly);
+        const uint8_t setRegisterMap(volatile uint8_t* registers, const uint16_t size);
+
+        void setSlaveHandlers(const SlaveHandler* handlers, const uint8_t count);
+        const uint8_t getMatchedAddress(void);
+
+#ifdef TWI_INSTRUMENTATION
+        void snapshot  (TWI_Stats* stats);
+        void resetStats(void);
+#endif
 
         void isr(void);
 
     private:
-        volatile uint8_t* twbr;   //< Pointer to the TWI bit rate register.
-        volatile uint8_t* twsr;   //< Pointer to the TWI status register.
-        volatile uint8_t* twar;   //< Pointer to the TWI address register.
-        volatile uint8_t* twdr;   //< Pointer to the TWI data register.
-        volatile uint8_t* twcr;   //< Pointer to the TWI control register.
-        volatile uint8_t* twamr;  //< Pointer to the TWI address mask register.
-        
+#ifdef TWI_LEAN
+        uint8_t began : 1;                        //< Flag indicating whether TWI communication has begun.
+        uint8_t role : 1;                         //< The role of the interface (master or slave).
+        TWI_Clock clock;                          //< The bus clock settings, the computed TWBR/TWPS.
+        volatile uint8_t state;                   //< The current state of the TWI interface, a byte of its own: the foreground writes it unmasked.
+        volatile uint8_t sendStop : 1;            //< Flag indicating whether a stop condition should be sent.
+        volatile uint8_t inRepStart : 1;          //< Flag indicating if a repeated start condition is active.
+        volatile uint8_t joined : 1;              //< Flag indicating whether a repeated START joined the last slave frame to the next one.
+#else
         uint8_t began;                            //< Flag indicating whether TWI communication has begun.
-        uint32_t frequency;                       //< The current frequency of the TWI interface.
         uint8_t role;                             //< The role of the interface (master or slave).
+        TWI_Clock clock;                          //< The bus clock settings, the computed TWBR/TWPS.
         volatile uint8_t state;                   //< The current state of the TWI interface.
         volatile uint8_t sendStop;                //< Flag indicating whether a stop condition should be sent.
         volatile uint8_t inRepStart;              //< Flag indicating if a repeated start condition is active.
+        volatile uint8_t joined;                  //< Flag indicating whether a repeated START joined the last slave frame to the next one.
+#endif
         volatile uint8_t status;                  //< The status of the current TWI operation.
         volatile uint8_t address;                 //< The address of the TWI device.
-        volatile uint8_t bufferIndex;             //< The current index in the data buffer.
-        volatile uint8_t bufferSize;              //< The size of the data buffer.
-        volatile uint8_t buffer[TWI_BUFFER_SIZE]; //< The buffer for storing data.
+        volatile length_t bufferIndex;            //< The current index in the data buffer.
+        volatile length_t bufferSize;             //< The size of the data buffer.
+#ifdef TWI_SHARED_BUFFER
+        static_assert(BUFFER_SIZE <= TWI_BUFFER_SIZE, "A shared buffer holds TWI_BUFFER_SIZE bytes");
+        static constexpr volatile uint8_t* buffer = TWI_SharedBuffer;  //< The buffer for storing data, shared by all instances.
+#else
+        volatile uint8_t buffer[BUFFER_SIZE];     //< The buffer for storing data.
+#endif
+
+        TWI_Transaction transfer;                   //< The transaction describing the buffered master transfer.
+        TWI_Transaction* volatile transaction;      //< The master transaction currently on the bus.
+        const uint8_t* txData;                      //< The bytes the ISR is transmitting.
+        uint8_t* rxData;                            //< The destination of the bytes the ISR is receiving.
+        volatile uint16_t length;                   //< The number of bytes of the current master transaction.
+        volatile uint16_t index;                    //< The index of the next byte of the current master transaction.
+        const uint8_t* txNext;                      //< The bytes the ISR transmits after `txData`.
+        volatile uint16_t split;                    //< The number of bytes transmitted from `txData` before `txNext`.
+        volatile uint16_t polls;                    //< The remaining retries of a refused address.
+        volatile uint8_t smbus;                     //< The SMBus flags of the current master transaction.
+        volatile uint8_t crc;                       //< The running SMBus PEC of the current message.
+        uint8_t pec;                                //< Flag indicating whether SMBus PEC is used in slave mode.
+        volatile uint8_t pecValid;                  //< Flag indicating whether the last frame received in slave mode had a valid PEC.
+        volatile uint8_t retries;                   //< The remaining retries of the current master transaction.
+        volatile uint16_t backoff;                  //< The remaining silence before the next retry in microseconds, `0` if none is pending.
+        TWI_Transaction* queue[TWI_QUEUE_SIZE];     //< The ring of queued master transactions.
+        volatile uint8_t queueHead;                 //< The index of the oldest queued transaction.
+        volatile uint8_t queueCount;                //< The number of queued transactions.
 
-        void (*rxCallback)(const uint8_t size); //< The callback function for receiving data.
+#ifndef TWI_LEAN
+        TWI_Frame* ring;                            //< The ring of frames received in slave mode.
+        uint8_t ringSize;                           //< The number of frames in the ring.
+        volatile uint8_t ringHead;                  //< The index of the frame the ISR fills next.
+        volatile uint8_t ringTail;                  //< The index of the oldest frame not yet drained.
+        TWI_Frame* frame;                           //< The frame the ISR is filling, NULL if the ring is full.
+
+        const TWI_ScanEntry* scanList;              //< The register blocks of the scan.
+        uint8_t scanCount;                          //< The number of entries in the scan list.
+        volatile uint8_t scanIndex;                 //< The entry being read, `scanCount` while no pass is running.
+        volatile uint8_t scanFailed;                //< The number of entries that failed in the current pass.
+        volatile uint8_t scanReady;                 //< Flag indicating a finished pass waits to be taken.
+        uint8_t* volatile scanFront;                //< The snapshot the application reads.
+        uint8_t* volatile scanBack;                 //< The snapshot the ISR fills.
+        TWI_Transaction scanTransfer;               //< The transaction reading the current entry.
+#endif
+
+        volatile uint8_t* registerMap;              //< The memory region served in slave mode.
+        uint16_t registerCount;                     //< The number of registers in the region.
+        const uint8_t* readOnlyMask;                //< Bit mask of registers the master cannot write.
+        const uint8_t* writeOnlyMask;               //< Bit mask of registers the master cannot read.
+        volatile uint8_t registerPointer;           //< The register served by the next access.
+        volatile uint8_t registerPending;           //< Flag indicating the next written byte sets the register pointer.
+
+        const SlaveHandler* handlers;               //< The table of virtual slave devices.
+        uint8_t handlerCount;                       //< The number of entries in the table.
+        const SlaveHandler* handler;                //< The handler of the matched address, NULL if none.
+        volatile uint8_t matched;                   //< The 7-bit address matched by the last slave access.
+
+        uint16_t timeout;                           //< The maximum time without bus progress in microseconds.
+        volatile uint8_t activity;                  //< Counter of ISR invocations, the bus progress seen by timeouts.
+        uint8_t controlMask;                        //< ANDed into every TWCR write, clears TWIE in polling mode.
+        uint8_t sleeping;                           //< Flag indicating whether the blocking waits sleep until the next interrupt.
+
+#ifdef TWI_INSTRUMENTATION
+        TWI_Stats stats;                            //< The counters and status trace of the bus.
+#endif
+
+        void (*rxCallback)(const length_t size); //< The callback function for receiving data.
         void (*txCallback)();                   //< The callback function for transmitting data.
+        void (*doneCallback)(const uint8_t status); //< The callback function for finished master transactions.
+#ifndef TWI_LEAN
+        void (*frameCallback)(const uint8_t* data, const uint8_t length); //< The callback function for dispatched slave frames.
+#endif
+        uint8_t (*txProducer)(void);            //< The function producing every byte transmitted in slave mode.
 
         void releaseBus(void); //< Releases the TWI bus.
         void stop(void);       //< Sends a stop condition to terminate TWI communication.
+        const uint8_t stopped(void); //< Waits for the last stop condition, bounded by `TWI_STOP_TIMEOUT`.
+        void complete(void);   //< Finishes the current master transaction.
+        const uint8_t dequeue(TWI_Transaction* transaction); //< Removes a transaction from the queue.
+#ifndef TWI_LEAN
+        TWI_Transaction* scanEntry(void); //< Prepares the transaction of the current scan entry.
+#endif
+        void finish(void);     //< Ends the current master transaction on the bus.
+        void load(TWI_Transaction* transaction, const uint8_t sendStop); //< Prepares a master transaction for the ISR.
+        void launch(void);     //< Puts the prepared master transaction on the bus.
+        const uint8_t submit(const uint8_t sendStop); //< Puts the buffered transfer on the bus, waiting again if the bus was taken.
+        void restart(void);    //< Turns the current master transaction around into its read part.
+        typedef void (*Transition)(__TWI__* twi); //< A state transition handler of the ISR.
+        static const Transition transitions[32];  //< The handlers indexed by `status >> 3`, in flash.
+        template <void (__TWI__::*HANDLER)(void)>
+        static void transition(__TWI__* twi);     //< Calls a handler on an instance.
+
+        void onStart(void);             //< START or repeated START sent.
+        void onMasterTransmit(void);    //< Address or data acknowledged as master transmitter.
+        void onMasterNack(void);        //< Address or data not acknowledged as master.
+        void onArbitrationLost(void);   //< Arbitration lost as master.
+        void onMasterData(void);        //< Data received and acknowledged as master.
+        void onMasterReceive(void);     //< Ready to receive as master.
+        void onMasterLastData(void);    //< Last data received as master.
+        void onSlaveReceive(void);      //< Addressed as slave receiver.
+        void onSlaveData(void);         //< Data received as slave.
+        void onSlaveStop(void);         //< STOP or repeated START received as slave.
+        void onSlaveReceiveEnd(void);   //< Slave reception ended.
+        void onSlaveTransmit(void);     //< Addressed as slave transmitter.
+        void onSlaveTransmitData(void); //< Data acknowledged as slave transmitter.
+        void onSlaveTransmitEnd(void);  //< Slave transmission ended.
+        void produce(void);             //< Sends the next byte of the slave TX producer.
+        void onNoInfo(void);            //< No relevant state information.
+        void onBusError(void);          //< Illegal START or STOP on the bus.
+
+        void receiveDone(void); //< Finishes a frame received in slave mode.
+        void writeRegister(const uint8_t byte); //< Stores a byte written by the master into the register map.
+        void readRegister(void); //< Serves the next register of the register map to the master.
+        void match(void);       //< Latches the matched slave address and selects its handler.
+        static const uint8_t crc8(uint8_t crc, const uint8_t byte); //< Updates an SMBus PEC with a byte.
+        void control(const uint8_t value); //< Writes the TWI control register, without TWIE in polling mode.
+        const uint8_t idle(void); //< Waits until the interface is ready, bounded by the timeout.
+        const uint8_t expired(uint16_t* remaining, uint8_t* seen, const uint16_t timeout); //< Checks whether the bus made no progress in time.
+        const uint8_t recoverBus(const uint8_t status); //< Aborts the current transaction and clears a stuck bus.
+        static void lineLow(const uint8_t mask);     //< Drives bus lines low as open-drain GPIOs.
+        static void lineRelease(const uint8_t mask); //< Releases bus lines to their pull-ups.
+#ifdef TWI_INSTRUMENTATION
+        void record(const uint8_t status); //< Counts and traces a status code seen by the ISR.
+#endif
 };
 
 
 #if defined(__AVR_ATmega328__)  || \
     defined(__AVR_ATmega328P__) || \
     defined(__AVR_ATmega328PB__)
-    extern __TWI__ TWI0;
+    typedef __TWI__<TWI0_Registers, TWI0_BUFFER_SIZE> TWI0_Bus;
+    extern TWI0_Bus TWI0;
 #endif
 
 #if defined(__AVR_ATmega328PB__)
-    extern __TWI__ TWI1;
+    typedef __TWI__<TWI1_Registers, TWI1_BUFFER_SIZE> TWI1_Bus;
+    extern TWI1_Bus TWI1;
+#endif
+
+#if defined(TWI_HOST)
+    typedef __TWI__<TWI_HostRegisters, TWI0_BUFFER_SIZE> TWI0_Bus;
+    extern TWI0_Bus TWI0;
 #endif
 
 #endif
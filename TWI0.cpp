@@ -13,10 +13,10 @@
     /**
      * @brief Create an instance of the TWI interface for ATmega328/328P.
      * 
-     * This instantiates a __TWI__ object using the corresponding register pointers for 
+     * This instantiates a __TWI__ object bound to the corresponding register set of 
      * ATmega328/328P.
      */
-    __TWI__ TWI0 = __TWI__(&TWBR, &TWSR, &TWAR, &TWDR, &TWCR, &TWAMR);
+    TWI0_Bus TWI0;
 
     /**
      * @brief TWI interrupt service routine for ATmega328/328P.
@@ -32,10 +32,10 @@
     /**
      * @brief Create an instance of the TWI interface for ATmega328PB.
      * 
-     * This instantiates a __TWI__ object using the corresponding register pointers for 
+     * This instantiates a __TWI__ object bound to the corresponding register set of 
      * ATmega328PB.
      */
-    __TWI__ TWI0 = __TWI__(&TWBR0, &TWSR0, &TWAR0, &TWDR0, &TWCR0, &TWAMR0);
+    TWI0_Bus TWI0;
 
     /**
      * @brief TWI interrupt service routine for ATmega328PB.
@@ -12,10 +12,10 @@
     /**
      * @brief Create an instance of the TWI1 interface for ATmega328PB.
      * 
-     * This instantiates a __TWI__ object using the corresponding register pointers for 
+     * This instantiates a __TWI__ object bound to the corresponding register set of 
      * TWI1 on the ATmega328PB microcontroller.
      */
-    __TWI__ TWI1 = __TWI__(&TWBR1, &TWSR1, &TWAR1, &TWDR1, &TWCR1, &TWAMR1);
+    TWI1_Bus TWI1;
 
     /**
      * @brief TWI1 interrupt service routine for ATmega328PB.
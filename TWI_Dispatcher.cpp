@@ -0,0 +1,200 @@
+/* Dependencies */
+#include "TWI_Dispatcher.h"
+
+
+/**
+ * @brief Initializes both buses as masters.
+ *
+ * @param frequency The SCL frequency of both buses.
+ *
+ * @return `1` if both buses were initialized, `0` otherwise.
+ */
+template <class BUS0, class BUS1>
+const uint8_t TWI_Dispatcher<BUS0, BUS1>::begin(const uint32_t frequency)
+{
+    const uint8_t first = this->bus0.begin(frequency);   /**< Initialize the first bus... */
+    const uint8_t second = this->bus1.begin(frequency);  /**< ...and the second one. */
+
+    return (first && second);  /**< Both must be up. */
+}
+
+
+/**
+ * @brief Initializes both buses as masters with the default frequency.
+ *
+ * @return `1` if both buses were initialized, `0` otherwise.
+ */
+template <class BUS0, class BUS1>
+const uint8_t TWI_Dispatcher<BUS0, BUS1>::begin(void)
+{
+    return (this->begin(TWI_DEFAULT_FREQUENCY));  /**< Initialize with the default frequency. */
+}
+
+
+/**
+ * @brief Maps a device address to a bus.
+ *
+ * @param address The 7-bit address of the device.
+ * @param bus `0` for the first bus, `1` for the second one.
+ *
+ * @return `1` if the address was mapped, `0` if the address or the bus is invalid.
+ */
+template <class BUS0, class BUS1>
+const uint8_t TWI_Dispatcher<BUS0, BUS1>::assign(const uint8_t address, const uint8_t bus)
+{
+    if (address > 0x7F || bus > 1)  /**< Check the arguments. */
+        return (0);
+
+    if (bus)  /**< Set or clear the bit of the address. */
+        this->map[address >> 3] |= (1 << (address & 7));
+    else
+        this->map[address >> 3] &= ~(1 << (address & 7));
+
+    return (1);  /**< Return 1 to indicate the address was mapped. */
+}
+
+
+/**
+ * @brief Returns the bus a device is mapped to.
+ *
+ * @param address The 7-bit address of the device.
+ *
+ * @return `0` for the first bus, `1` for the second one.
+ */
+template <class BUS0, class BUS1>
+const uint8_t TWI_Dispatcher<BUS0, BUS1>::route(const uint8_t address)
+{
+    return ((this->map[(address >> 3) & 0x0F] >> (address & 7)) & 1);  /**< Look the bit of the address up. */
+}
+
+
+/**
+ * @brief Queues a master transaction on the bus of its device.
+ *
+ * @param transaction Pointer to the transaction, see `__TWI__::enqueue()`.
+ *
+ * @return `1` if the transaction was queued, `0` if the queue of its bus is full.
+ */
+template <class BUS0, class BUS1>
+const uint8_t TWI_Dispatcher<BUS0, BUS1>::enqueue(TWI_Transaction* transaction)
+{
+    if (this->route(transaction->address))  /**< Hand it to the bus of the device. */
+        return (this->bus1.enqueue(transaction));
+    return (this->bus0.enqueue(transaction));
+}
+
+
+/**
+ * @brief Returns the number of transactions waiting in the queues of both buses.
+ *
+ * @return The number of queued transactions.
+ */
+template <class BUS0, class BUS1>
+const uint8_t TWI_Dispatcher<BUS0, BUS1>::queued(void)
+{
+    return (this->bus0.queued() + this->bus1.queued());  /**< Sum both queues. */
+}
+
+
+/**
+ * @brief Advances a task on the bus of its device without blocking.
+ *
+ * @param task Pointer to the task, see `__TWI__::poll(TWI_Task*)`.
+ *
+ * @return The state of the task.
+ */
+template <class BUS0, class BUS1>
+const uint8_t TWI_Dispatcher<BUS0, BUS1>::poll(TWI_Task* task)
+{
+    if (this->route(task->transaction.address))  /**< Advance it on the bus of the device. */
+        return (this->bus1.poll(task));
+    return (this->bus0.poll(task));
+}
+
+
+/**
+ * @brief Waits for a transaction to finish on the bus of its device.
+ *
+ * The other bus keeps running its own transactions meanwhile.
+ *
+ * @param transaction Pointer to the transaction to wait for.
+ * @param timeout The maximum time without bus progress in microseconds, `0` waits forever.
+ *
+ * @return The final status of the transaction.
+ */
+template <class BUS0, class BUS1>
+const uint8_t TWI_Dispatcher<BUS0, BUS1>::wait(TWI_Transaction* transaction, const uint16_t timeout)
+{
+    if (this->route(transaction->address))  /**< Wait on the bus of the device. */
+        return (this->bus1.wait(transaction, timeout));
+    return (this->bus0.wait(transaction, timeout));
+}
+
+
+/**
+ * @brief Writes to a device on its bus, blocking until done.
+ *
+ * @param address The 7-bit address of the device.
+ * @param data Pointer to the data to write.
+ * @param size The number of bytes to write.
+ *
+ * @return The TWI status of the transmission, see `__TWI__::transmit()`.
+ */
+template <class BUS0, class BUS1>
+const uint8_t TWI_Dispatcher<BUS0, BUS1>::transmit(const uint8_t address, const void* data, const uint16_t size)
+{
+    if (this->route(address))  /**< Write on the bus of the device. */
+        return (this->bus1.transmit(address, data, size));
+    return (this->bus0.transmit(address, data, size));
+}
+
+
+/**
+ * @brief Reads from a device on its bus, blocking until done.
+ *
+ * @param address The 7-bit address of the device.
+ * @param destination Pointer to the destination of the data.
+ * @param length The number of bytes to read.
+ *
+ * @return The number of bytes received.
+ */
+template <class BUS0, class BUS1>
+const uint16_t TWI_Dispatcher<BUS0, BUS1>::requestFrom(const uint8_t address, void* destination, const uint16_t length)
+{
+    if (this->route(address))  /**< Read on the bus of the device. */
+        return (this->bus1.requestFrom(address, destination, length));
+    return (this->bus0.requestFrom(address, destination, length));
+}
+
+
+/**
+ * @brief Writes to and then reads from a device on its bus, blocking until done.
+ *
+ * @param address The 7-bit address of the device.
+ * @param source Pointer to the data to write.
+ * @param size The number of bytes to write.
+ * @param destination Pointer to the destination of the data.
+ * @param length The number of bytes to read.
+ *
+ * @return The number of bytes received.
+ */
+template <class BUS0, class BUS1>
+const uint16_t TWI_Dispatcher<BUS0, BUS1>::writeThenRead(const uint8_t address, const void* source, const uint16_t size, void* destination, const uint16_t length)
+{
+    if (this->route(address))  /**< Run it on the bus of the device. */
+        return (this->bus1.writeThenRead(address, source, size, destination, length));
+    return (this->bus0.writeThenRead(address, source, size, destination, length));
+}
+
+
+/**
+ * @brief Explicit instantiation of the dispatcher for the two buses of the ATmega328PB, 
+ *        and for the one simulated bus of the host build.
+ */
+#if defined(__AVR_ATmega328PB__)
+    template class TWI_Dispatcher<TWI0_Bus, TWI1_Bus>;
+#endif
+
+#if defined(TWI_HOST)
+    template class TWI_Dispatcher<TWI0_Bus, TWI0_Bus>;
+#endif
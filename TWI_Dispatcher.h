@@ -0,0 +1,65 @@
+#ifndef __TWI_DISPATCHER_H__
+#define __TWI_DISPATCHER_H__
+
+/* Dependecies */
+#include "TWI.h"
+
+/**
+ * @brief Routes master transactions to one of two TWI buses by device address.
+ *
+ * The dispatcher drives two independent buses as masters, e.g. `TWI0` and `TWI1` of the
+ * ATmega328PB. Every 7-bit address is mapped to one of them (bus 0 unless assigned
+ * otherwise), and transactions are handed to the queue of that bus. Each bus runs its
+ * transactions from its own ISR, so devices split across the buses are served at the
+ * same time.
+ *
+ * The partitioning is manual: a device is wired to one bus, so the dispatcher never moves
+ * a transaction to the less busy one. The aggregate throughput approaches twice that of
+ * one bus only as far as `assign()` splits the traffic evenly; with everything on bus 0
+ * it is that of one bus.
+ *
+ * @code
+ * TWI_DualBus sensors(TWI0, TWI1);
+ *
+ * sensors.begin(400000);
+ * sensors.assign(0x1E, 1);           // The second magnetometer hangs on TWI1.
+ * sensors.enqueue(&read_left);       // Goes to TWI0...
+ * sensors.enqueue(&read_right);      // ...and runs at the same time on TWI1.
+ * @endcode
+ */
+template <class BUS0, class BUS1>
+class TWI_Dispatcher
+{
+    public:
+        constexpr TWI_Dispatcher(BUS0& bus0, BUS1& bus1) : bus0(bus0), bus1(bus1), map() {}
+
+        const uint8_t begin (const uint32_t frequency);
+        const uint8_t begin (void);
+        const uint8_t assign(const uint8_t address, const uint8_t bus);
+        const uint8_t route (const uint8_t address);
+
+        const uint8_t enqueue(TWI_Transaction* transaction);
+        const uint8_t queued (void);
+        const uint8_t poll   (TWI_Task* task);
+        const uint8_t wait   (TWI_Transaction* transaction, const uint16_t timeout);
+
+        const uint8_t transmit      (const uint8_t address, const void* data, const uint16_t size);
+        const uint16_t requestFrom  (const uint8_t address, void* destination, const uint16_t length);
+        const uint16_t writeThenRead(const uint8_t address, const void* source, const uint16_t size, void* destination, const uint16_t length);
+
+    private:
+        BUS0& bus0;       //< The first bus.
+        BUS1& bus1;       //< The second bus.
+        uint8_t map[16];  //< One bit per 7-bit address, set for devices on the second bus.
+};
+
+
+#if defined(__AVR_ATmega328PB__)
+    typedef TWI_Dispatcher<TWI0_Bus, TWI1_Bus> TWI_DualBus;
+#endif
+
+#if defined(TWI_HOST)
+    typedef TWI_Dispatcher<TWI0_Bus, TWI0_Bus> TWI_DualBus;  //< The simulator has one bus, both sides drive it.
+#endif
+
+#endif
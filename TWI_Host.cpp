@@ -0,0 +1,773 @@
+/* Dependencies */
+#include "TWI.h"
+
+#if defined(TWI_HOST)
+
+#define TWI_SIM_IDLE     (const uint8_t)0
+#define TWI_SIM_ADDRESS  (const uint8_t)1
+#define TWI_SIM_TRANSMIT (const uint8_t)2
+#define TWI_SIM_RECEIVE  (const uint8_t)3
+
+#define TWI_SIM_NEVER    (const uint64_t)0xFFFFFFFFFFFFFFFFULL  //< The due time of an operation stalled by a held line.
+
+/**
+ * @brief Interrupt vector of the simulated TWI peripheral.
+ *
+ * Called by the simulator whenever TWINT is set with TWIE and interrupts enabled,
+ * invoking the `isr` method of the TWI0 object.
+ */
+static void TWI_HOST_vect(void)
+{
+    TWI0.isr();  //*< Calls the isr method of TWI0 to handle TWI interrupts.
+}
+
+/**
+ * @brief Create the simulated TWI peripheral and the instance bound to it.
+ */
+TWI_Simulator TWI_Sim(TWI_HOST_vect);
+TWI0_Bus TWI0;
+
+
+/**
+ * @brief Constructs the simulator with an idle bus.
+ *
+ * @param vector The function called as interrupt vector of the TWI peripheral.
+ */
+TWI_Simulator::TWI_Simulator(void (*vector)(void)) :
+    twbr(0), twsr(0), twar(0), twdr(0xFF), twamr(0), port(0),
+    vector(vector), devices(NULL), deviceCount(0), device(NULL), twcr(0), ddr(0), sdaHold(0), sclHold(0),
+    stopDelay(0), wakeup(NULL), stopping(0), starting(0), stopDue(0), maskedSince(0), interrupts(1), inIsr(0),
+    phase(TWI_SIM_IDLE), owned(0), joining(0), written(0), pending(0), pendingStatus(0), due(0), length(0), time(0),
+    released(0), active(0), stats()
+{
+}
+
+
+/**
+ * @brief Attaches the simulated slave devices to the bus.
+ *
+ * @param devices Pointer to the array of devices.
+ * @param count The number of devices in the array.
+ */
+void TWI_Simulator::attach(TWI_SimDevice* devices, const uint8_t count)
+{
+    this->devices = devices;    /**< Store the device table. */
+    this->deviceCount = count;  /**< Store its size. */
+}
+
+
+/**
+ * @brief Lets time pass for the foreground, like `_delay_us()` on the target.
+ *
+ * Bus operations ending in this time complete and their interrupts are serviced. The
+ * time is accounted as foreground wait time unless called from the ISR.
+ *
+ * @param microseconds The time to pass.
+ */
+void TWI_Simulator::run(const uint32_t microseconds)
+{
+    const uint64_t cycles = (uint64_t)microseconds * (F_CPU / 1000000UL);  /**< Convert to CPU cycles. */
+
+    if (!this->inIsr)  /**< Time spent by the foreground. */
+        this->stats.waitCycles += cycles;
+
+    this->service();          /**< An interrupt may have become pending meanwhile. */
+    this->advance(cycles);    /**< Let the bus run. */
+}
+
+
+/**
+ * @brief Sleeps until the next interrupt, like `sleep_cpu()` on the target.
+ *
+ * The CPU wakes when the bus operation in progress ends and raises the TWI interrupt,
+ * or after the given time, which stands for the next periodic interrupt (e.g. a timer
+ * tick). The time is accounted as sleep time.
+ *
+ * @param microseconds The longest time to sleep.
+ */
+void TWI_Simulator::sleep(const uint32_t microseconds)
+{
+    const uint64_t start = this->time;  /**< The time the CPU falls asleep. */
+    const uint64_t target = start + (uint64_t)microseconds * (F_CPU / 1000000UL);  /**< The next periodic interrupt. */
+    const uint32_t interrupts = this->stats.interrupts;  /**< The TWI interrupts so far. */
+
+    if (this->wakeup != NULL)  /**< An event arrives while the CPU sleeps. */
+    {
+        void (*function)(void) = this->wakeup;
+        this->wakeup = NULL;  /**< Only once. */
+        function();
+    }
+
+    while (this->stats.interrupts == interrupts && this->time < target)  /**< Until an interrupt wakes the CPU. */
+    {
+        uint64_t next = target;  /**< Step to the next bus event, a STOP may be followed by a START. */
+        if (this->pending && this->due < next)
+            next = this->due;
+        if (this->stopping && this->stopDue < next)
+            next = this->stopDue;
+        this->advance(next - this->time);  /**< Let the bus run, the ISR wakes the CPU. */
+    }
+
+    this->stats.sleepCycles += this->time - start;
+}
+
+
+/**
+ * @brief Advances the simulated time.
+ *
+ * Every bus operation that ends within the time stores its status, sets TWINT and runs
+ * the ISR if interrupts allow it. The ISR usually starts the next operation, which ends
+ * within the same call if it is short enough.
+ *
+ * @param cycles The number of CPU cycles to advance.
+ */
+void TWI_Simulator::advance(const uint64_t cycles)
+{
+    const uint64_t target = this->time + cycles;  /**< The time to advance to. */
+
+    while (1)
+    {
+        if (this->stopping && this->stopDue <= target && (!this->pending || this->stopDue <= this->due))  /**< The STOP ends first. */
+        {
+            this->time = this->stopDue;  /**< Jump to its end. */
+            this->stopped();
+            continue;
+        }
+
+        if (!this->pending || this->due > target)  /**< No operation ends in time. */
+            break;
+
+        this->time = this->due;  /**< Jump to its end. */
+        this->pending = 0;       /**< The bus waits for the software again. */
+        this->twsr = (this->pendingStatus & 0xF8) | (this->twsr & 0x03);  /**< Store the status, keep the prescaler. */
+        this->twcr |= (1 << TWINT);  /**< Raise the interrupt flag. */
+        this->service();  /**< Run the ISR. */
+    }
+
+    if (this->time < target)  /**< The ISR may have advanced past the target already. */
+        this->time = target;
+}
+
+
+/**
+ * @brief Returns the simulated time.
+ *
+ * @return The time since the start in CPU cycles.
+ */
+const uint64_t TWI_Simulator::now(void)
+{
+    return (this->time);  /**< Return the time. */
+}
+
+
+/**
+ * @brief Plays an external master writing to the simulated peripheral in slave mode.
+ *
+ * A START, the address with the write bit, the data and a STOP are clocked onto the bus,
+ * the ISR of the bound instance runs for every status like on the target.
+ *
+ * @param address The 7-bit address to write to, `0` for a general call.
+ * @param data Pointer to the data to write.
+ * @param size The number of bytes to write.
+ *
+ * @return The number of bytes the slave acknowledged, `0` if the address was refused
+ *         or the bus is busy.
+ */
+const uint16_t TWI_Simulator::masterWrite(const uint8_t address, const uint8_t* data, const uint16_t size)
+{
+    if (this->owned || this->pending || this->stopping || this->stuck())  /**< The bus is in use or hung. */
+        return (0);
+
+    this->stats.transactions++;  /**< Count the START. */
+
+    if (!this->addressed(address))  /**< Nobody answers the address. */
+    {
+        this->stats.busCycles += 11 * this->bit();  /**< START, address and STOP. */
+        this->advance(11 * this->bit());
+        return (0);
+    }
+
+    this->twdr = (address << 1) | TW_WRITE;  /**< The address byte is received into TWDR. */
+    this->raise(address ? TW_SR_SLA_ACK : TW_SR_GCALL_ACK, 10 * this->bit());  /**< START and address. */
+
+    uint16_t count = 0;  /**< The number of acknowledged bytes. */
+    while (count < size)
+    {
+        const uint8_t ack = this->twcr & (1 << TWEA);  /**< The slave decided before the byte arrived. */
+        this->twdr = data[count];  /**< Shift the byte in. */
+        if (address)
+            this->raise(ack ? TW_SR_DATA_ACK : TW_SR_DATA_NACK, 9 * this->bit());
+        else
+            this->raise(ack ? TW_SR_GCALL_DATA_ACK : TW_SR_GCALL_DATA_NACK, 9 * this->bit());
+        if (!ack)  /**< The slave refused the byte and stopped listening. */
+        {
+            this->stats.busCycles += this->bit();  /**< The master ends with a STOP. */
+            this->advance(this->bit());
+            return (count);
+        }
+        count++;
+    }
+
+    this->raise(TW_SR_STOP, this->bit());  /**< The master ends with a STOP, or a repeated START while joining. */
+
+    return (count);  /**< Return the number of acknowledged bytes. */
+}
+
+
+/**
+ * @brief Plays an external master reading from the simulated peripheral in slave mode.
+ *
+ * A START, the address with the read bit, the data and a STOP are clocked onto the bus,
+ * the ISR of the bound instance runs for every status like on the target. The master
+ * acknowledges every byte except the last one; bytes after the slave's last one read as
+ * `0xFF`.
+ *
+ * @param address The 7-bit address to read from.
+ * @param data Pointer to the destination of the data.
+ * @param size The number of bytes to read.
+ *
+ * @return The number of bytes the slave sent, `0` if the address was refused or the
+ *         bus is busy.
+ */
+const uint16_t TWI_Simulator::masterRead(const uint8_t address, uint8_t* data, const uint16_t size)
+{
+    if (this->owned || this->pending || this->stopping || this->stuck() || !size)  /**< The bus is in use or hung, or nothing to read. */
+        return (0);
+
+    this->stats.transactions++;  /**< Count the START. */
+
+    if (!address || !this->addressed(address))  /**< Nobody answers the address. */
+    {
+        this->stats.busCycles += 11 * this->bit();  /**< START, address and STOP. */
+        this->advance(11 * this->bit());
+        return (0);
+    }
+
+    this->twdr = (address << 1) | TW_READ;  /**< The address byte is received into TWDR. */
+    this->raise(TW_ST_SLA_ACK, 10 * this->bit());  /**< START and address, the ISR loads the first byte. */
+
+    uint16_t count = 0;  /**< The number of bytes sent by the slave. */
+    while (1)
+    {
+        const uint8_t more = this->twcr & (1 << TWEA);  /**< The slave expects to send more. */
+        data[count++] = this->twdr;  /**< Shift the byte out. */
+        if (count >= size)  /**< The master NACKs its last byte. */
+        {
+            this->raise(TW_ST_DATA_NACK, 9 * this->bit());
+            break;
+        }
+        if (!more)  /**< The master wants more than the slave has. */
+        {
+            this->raise(TW_ST_LAST_DATA, 9 * this->bit());
+            break;
+        }
+        this->raise(TW_ST_DATA_ACK, 9 * this->bit());  /**< The ISR loads the next byte. */
+    }
+
+    for (uint16_t i = count; i < size; i++)  /**< The slave no longer drives SDA. */
+        data[i] = 0xFF;
+    this->stats.busCycles += (uint64_t)(size - count) * 9 * this->bit() + this->bit();  /**< The remaining bytes and the STOP. */
+    this->advance((uint64_t)(size - count) * 9 * this->bit() + this->bit());
+
+    return (count);  /**< Return the number of bytes sent by the slave. */
+}
+
+
+/**
+ * @brief Plays an external master writing to the simulated peripheral, then reading from 
+ * it after a repeated START.
+ *
+ * The repeated START ends the write with the same status as a STOP, but SDA reads low 
+ * while the ISR handles it, like on the bus.
+ *
+ * @param address The 7-bit address to write to and read from.
+ * @param data Pointer to the data to write.
+ * @param size The number of bytes to write.
+ * @param destination Pointer to the destination of the data read.
+ * @param length The number of bytes to read.
+ *
+ * @return The number of bytes the slave sent, `0` if it refused the address or a byte 
+ *         written, or the bus is busy.
+ */
+const uint16_t TWI_Simulator::masterWriteRead(const uint8_t address, const uint8_t* data, const uint16_t size, uint8_t* destination, const uint16_t length)
+{
+    this->joining = 1;  /**< No STOP after the write... */
+    const uint16_t count = this->masterWrite(address, data, size);
+    this->joining = 0;  /**< ...the read follows at once. */
+
+    if (count < size)  /**< The write was refused, the master gave up with a STOP. */
+        return (0);
+
+    return (this->masterRead(address, destination, length));
+}
+
+
+/**
+ * @brief Copies the bus measurements.
+ *
+ * @param stats Pointer to the structure receiving the copy.
+ */
+void TWI_Simulator::snapshot(TWI_SimStats* stats)
+{
+    *stats = this->stats;  /**< Copy the measurements. */
+}
+
+
+/**
+ * @brief Clears the bus measurements.
+ */
+void TWI_Simulator::resetStats(void)
+{
+    this->stats = TWI_SimStats();  /**< Zero every measurement. */
+    this->active = 0;  /**< The next transaction has no idle gap before it. */
+}
+
+
+/**
+ * @brief Makes a slave hold SDA low, like one cut off in the middle of a byte it sends.
+ *
+ * The slave lets go after the given number of SCL pulses clocked by software with the TWI
+ * switched off, as in a bus recovery. Meanwhile no bus operation completes.
+ *
+ * @param pulses The SCL pulses until SDA is released, `TWI_SIM_FOREVER` to hold it until
+ *               called again, `0` to release it now.
+ */
+void TWI_Simulator::holdSda(const uint16_t pulses)
+{
+    this->sdaHold = pulses;  /**< Store the hold. */
+    this->resume();          /**< Stall or resume the bus. */
+}
+
+
+/**
+ * @brief Makes a slave hold SCL low, like a stretch that never ends.
+ *
+ * Meanwhile no bus operation completes and software pulses on SCL have no effect.
+ *
+ * @param held Non-zero to hold SCL low, `0` to release it.
+ */
+void TWI_Simulator::holdScl(const uint8_t held)
+{
+    this->sclHold = held;  /**< Store the hold. */
+    this->resume();        /**< Stall or resume the bus. */
+}
+
+
+/**
+ * @brief Delays the completion of every STOP condition sent as master.
+ *
+ * TWSTO stays set for one SCL period plus the delay, like on a bus whose SCL rises slowly.
+ * A START requested meanwhile follows the STOP.
+ *
+ * @param cycles The additional time in CPU cycles, `0` for a STOP of one SCL period.
+ */
+void TWI_Simulator::setStopDelay(const uint32_t cycles)
+{
+    this->stopDelay = cycles;  /**< Store the delay. */
+}
+
+
+/**
+ * @brief Sets an event arriving once the CPU next falls asleep in `sleep_cpu()`.
+ *
+ * The function runs once, right after the CPU fell asleep, so an external master played
+ * from it addresses the slave while the CPU sleeps.
+ *
+ * @param function The event, `NULL` for none.
+ */
+void TWI_Simulator::setWakeup(void (*function)(void))
+{
+    this->wakeup = function;  /**< Store the event. */
+}
+
+
+/**
+ * @brief Sets the global interrupt enable flag, like `sei()`/`cli()`.
+ *
+ * @param enabled Non-zero to enable interrupts.
+ */
+void TWI_Simulator::setInterrupts(const uint8_t enabled)
+{
+    this->mask(enabled);  /**< Store the flag. */
+    this->service();  /**< A pending interrupt runs as soon as interrupts are enabled. */
+}
+
+
+/**
+ * @brief Returns the global interrupt enable flag.
+ *
+ * @return Non-zero if interrupts are enabled.
+ */
+const uint8_t TWI_Simulator::getInterrupts(void)
+{
+    return (this->interrupts);  /**< Return the flag. */
+}
+
+
+/**
+ * @brief Reads the control register.
+ *
+ * @return The control bits and flags.
+ */
+const uint8_t TWI_Simulator::control(void)
+{
+    return (this->twcr);  /**< Return the control register. */
+}
+
+
+/**
+ * @brief Writes the control register.
+ *
+ * Writing a one to TWINT clears the flag and starts the bus operation the other bits
+ * select. TWSTO stays set for one SCL period, longer if `setStopDelay()` delays the STOP
+ * or a line is held low.
+ *
+ * @param value The value written to TWCR.
+ */
+void TWI_Simulator::control(const uint8_t value)
+{
+    if (!(value & (1 << TWEN)))  /**< The peripheral is switched off. */
+    {
+        this->twcr = value & ~((1 << TWINT) | (1 << TWSTO));  /**< Keep the written bits, the flag is cleared. */
+        this->pending = 0;              /**< Abort whatever was on the bus. */
+        this->stopping = 0;
+        this->starting = 0;
+        this->phase = TWI_SIM_IDLE;
+        this->owned = 0;
+        this->device = NULL;
+        this->released = this->time;
+        return;
+    }
+
+    const uint8_t stop = this->stopping ? (1 << TWSTO) : 0;  /**< TWSTO stays set until the STOP in progress ends. */
+
+    if (!(value & (1 << TWINT)))  /**< Only the enable bits change, the flag is untouched. */
+    {
+        this->twcr = (value & ~((1 << TWINT) | (1 << TWSTO))) | (this->twcr & (1 << TWINT)) | stop;
+        this->service();  /**< Enabling TWIE may let a pending interrupt through. */
+        return;
+    }
+
+    this->twcr = (value & ~((1 << TWINT) | (1 << TWSTO))) | stop;  /**< Writing a one clears the flag. */
+
+    if ((value & (1 << TWSTO)) && !this->stopping)  /**< STOP condition */
+    {
+        if (this->owned)  /**< Only a master puts a STOP on the bus. */
+        {
+            if (this->device != NULL && this->written && this->device->writeCycle)  /**< A write ended, the device gets busy. */
+                this->device->busyUntil = this->time + this->device->writeCycle;
+            this->stopping = 1;  /**< The STOP takes its time, TWSTO stays set meanwhile. */
+            this->stopDue = TWI_SIM_NEVER;
+            this->twcr |= (1 << TWSTO);
+            this->resume();      /**< Time it if the bus is free. */
+        }
+        this->owned = 0;  /**< The bus is free. */
+        this->phase = TWI_SIM_IDLE;
+        this->device = NULL;
+    }
+
+    if (value & (1 << TWSTA))  /**< START or repeated START condition */
+    {
+        if (this->stopping)  /**< It follows the STOP in progress. */
+            this->starting = 1;
+        else
+            this->start();
+        return;
+    }
+
+    if (value & (1 << TWSTO))  /**< Nothing more to clock. */
+        return;
+
+    switch (this->phase)  /**< Clock the next byte as master. */
+    {
+        case TWI_SIM_ADDRESS:  /**< The address in TWDR */
+        {
+            const uint8_t read = this->twdr & TW_READ;  /**< The direction bit. */
+            this->device = NULL;
+            for (uint8_t i = 0; i < this->deviceCount; i++)  /**< Look for the addressed device. */
+                if (this->devices[i].address == (this->twdr >> 1) && !this->devices[i].nackAddress && this->time >= this->devices[i].busyUntil)
+                    this->device = &this->devices[i];
+            this->written = 0;  /**< Nothing written to it yet. */
+            this->phase = read ? TWI_SIM_RECEIVE : TWI_SIM_TRANSMIT;
+            if (this->device == NULL)  /**< Nobody acknowledges the address. */
+                this->schedule(read ? TW_MR_SLA_NACK : TW_MT_SLA_NACK, 9 * this->bit());
+            else
+                this->schedule(read ? TW_MR_SLA_ACK : TW_MT_SLA_ACK, 9 * this->bit() + this->device->stretch);
+            break;
+        }
+
+        case TWI_SIM_TRANSMIT:  /**< The data byte in TWDR */
+            if (this->device == NULL || (this->device->nackAfter && this->written >= this->device->nackAfter))  /**< The byte is refused. */
+            {
+                this->schedule(TW_MT_DATA_NACK, 9 * this->bit());
+                break;
+            }
+            this->written++;  /**< One more byte accepted. */
+            if (this->device->write != NULL)  /**< Hand it to the device. */
+                this->device->write(this->twdr);
+            this->schedule(TW_MT_DATA_ACK, 9 * this->bit() + this->device->stretch);
+            break;
+
+        case TWI_SIM_RECEIVE:  /**< A data byte from the device */
+            this->twdr = (this->device != NULL && this->device->read != NULL) ? this->device->read() : 0xFF;  /**< The device drives SDA. */
+            this->schedule((value & (1 << TWEA)) ? TW_MR_DATA_ACK : TW_MR_DATA_NACK, 9 * this->bit() + (this->device != NULL ? this->device->stretch : 0));
+            break;
+
+        default:  /**< Acknowledging as slave, the external master clocks the bus. */
+            break;
+    }
+}
+
+
+/**
+ * @brief Reads the direction register of the SCL/SDA pins.
+ *
+ * @return The direction bits, a set bit drives the pin.
+ */
+const uint8_t TWI_Simulator::direction(void)
+{
+    return (this->ddr);  /**< Return the direction register. */
+}
+
+
+/**
+ * @brief Writes the direction register of the SCL/SDA pins.
+ *
+ * With the TWI switched off, releasing an SCL driven low that no slave holds clocks a
+ * pulse, which may make a slave holding SDA let go. An output with its port bit set, before
+ * or after the write, drives the line high and is counted in `drivenHigh`.
+ *
+ * @param value The value written to the direction register.
+ */
+void TWI_Simulator::direction(const uint8_t value)
+{
+    const uint8_t scl = (1 << TWI_SIM_SCL);  /**< The SCL pin mask. */
+    const uint8_t lines = scl | (1 << TWI_SIM_SDA);  /**< Both line masks. */
+
+    if (!(this->twcr & (1 << TWEN)))  /**< The pins are GPIOs. */
+    {
+        if ((this->ddr | value) & this->port & lines)  /**< A line is driven high. */
+            this->stats.drivenHigh++;
+        if ((this->ddr & ~this->port & scl) && !(value & scl) && !this->sclHold)  /**< SCL rises. */
+        {
+            this->stats.sclPulses++;
+            if (this->sdaHold && this->sdaHold != TWI_SIM_FOREVER && !--this->sdaHold)  /**< The slave finished its byte. */
+                this->resume();
+        }
+    }
+
+    this->ddr = value;  /**< Store the directions. */
+}
+
+
+/**
+ * @brief Reads the input register of the SCL/SDA pins.
+ *
+ * With the TWI switched off, reading a released line whose pull-up is off is counted in
+ * `floatingReads`: without external resistors its level would be undefined.
+ *
+ * @return The level of the lines, a line is high unless driven low or held by a slave.
+ */
+const uint8_t TWI_Simulator::pins(void)
+{
+    const uint8_t low = this->ddr & ~this->port;  /**< The pins driven low. */
+    uint8_t lines = 0;
+
+    if (!(this->twcr & (1 << TWEN)) && (~this->ddr & ~this->port & ((1 << TWI_SIM_SCL) | (1 << TWI_SIM_SDA))))  /**< A line floats. */
+        this->stats.floatingReads++;
+
+    if (!(low & (1 << TWI_SIM_SCL)) && !this->sclHold)
+        lines |= (1 << TWI_SIM_SCL);
+    if (!(low & (1 << TWI_SIM_SDA)) && !this->sdaHold && !this->joining)
+        lines |= (1 << TWI_SIM_SDA);
+
+    return (lines);  /**< Return the levels. */
+}
+
+
+/**
+ * @brief Returns the duration of one SCL period.
+ *
+ * @return `16 + 2 * TWBR * 4^TWPS` CPU cycles.
+ */
+const uint32_t TWI_Simulator::bit(void)
+{
+    return (16 + 2 * (uint32_t)this->twbr * (1UL << (2 * (this->twsr & 0x03))));  //*< The bit rate formula of the datasheet.
+}
+
+
+/**
+ * @brief Starts a bus operation.
+ *
+ * @param status The status the operation ends with.
+ * @param cycles The duration of the operation in CPU cycles.
+ */
+void TWI_Simulator::schedule(const uint8_t status, const uint64_t cycles)
+{
+    this->pending = 1;                       //*< An operation is in progress...
+    this->pendingStatus = status;            //*< ...ends with this status...
+    this->length = cycles;                   //*< ...takes this time...
+    this->due = TWI_SIM_NEVER;               //*< ...and hangs while a line is held low.
+    this->resume();                          //*< Time it if the bus is free.
+}
+
+
+/**
+ * @brief Checks whether a slave holds a line low.
+ *
+ * @return Non-zero if SDA or SCL is held.
+ */
+const uint8_t TWI_Simulator::stuck(void)
+{
+    return (this->sdaHold || this->sclHold);  //*< Either line blocks the bus.
+}
+
+
+/**
+ * @brief Stalls or resumes the bus after a line was held or released.
+ *
+ * A stalled operation keeps its remaining duration, a stalled STOP starts over; both
+ * continue once the lines are free and their bus time is accounted when they are timed.
+ */
+void TWI_Simulator::resume(void)
+{
+    if (this->stuck())  //*< Stall whatever is in progress.
+    {
+        if (this->pending && this->due != TWI_SIM_NEVER)
+        {
+            this->length = this->due - this->time;     //*< The time it still takes.
+            this->stats.busCycles -= this->length;     //*< It isn't clocked until resumed.
+            this->due = TWI_SIM_NEVER;
+        }
+        if (this->stopping && this->stopDue != TWI_SIM_NEVER)
+        {
+            this->stats.busCycles -= this->stopDue - this->time;  //*< Not clocked until resumed.
+            this->stopDue = TWI_SIM_NEVER;
+        }
+        return;
+    }
+
+    if (this->pending && this->due == TWI_SIM_NEVER)  //*< Time the stalled operation.
+    {
+        this->due = this->time + this->length;
+        this->stats.busCycles += this->length;   //*< The bus is busy meanwhile.
+    }
+    if (this->stopping && this->stopDue == TWI_SIM_NEVER)  //*< Time the STOP.
+    {
+        this->stopDue = this->time + this->bit() + this->stopDelay;
+        this->stats.busCycles += this->bit() + this->stopDelay;
+    }
+}
+
+
+/**
+ * @brief Clocks a START or repeated START condition.
+ *
+ * A START on an idle bus closes the idle gap since the last STOP.
+ */
+void TWI_Simulator::start(void)
+{
+    if (!this->owned && this->active)  //*< A new transaction on an idle bus
+    {
+        const uint64_t gap = this->time - this->released;  //*< Time the bus stood still.
+        this->stats.idleCycles += gap;
+        if (gap > this->stats.maxIdle)
+            this->stats.maxIdle = gap;
+    }
+    this->active = 1;  //*< Later transactions measure their gap.
+    this->stats.transactions++;
+    this->schedule(this->owned ? TW_REP_START : TW_START, this->bit());  //*< Clock the START.
+    this->owned = 1;  //*< The bus is held as master.
+    this->phase = TWI_SIM_ADDRESS;  //*< The next byte is the address.
+}
+
+
+/**
+ * @brief Completes the STOP in progress and clears TWSTO.
+ *
+ * A START requested meanwhile is clocked now.
+ */
+void TWI_Simulator::stopped(void)
+{
+    this->stopping = 0;           //*< The STOP is on the wire...
+    this->twcr &= ~(1 << TWSTO);  //*< ...the hardware clears the bit.
+    this->released = this->time;  //*< The idle gap starts here.
+
+    if (this->starting)  //*< A START waited for the STOP.
+    {
+        this->starting = 0;
+        this->start();
+    }
+}
+
+
+/**
+ * @brief Runs a bus operation of an external master to its end.
+ *
+ * @param status The status the operation ends with.
+ * @param cycles The duration of the operation in CPU cycles.
+ */
+void TWI_Simulator::raise(const uint8_t status, const uint64_t cycles)
+{
+    this->schedule(status, cycles);  //*< Start the operation...
+    this->advance(cycles);           //*< ...and let it complete, the ISR included.
+}
+
+
+/**
+ * @brief Runs the ISR if an interrupt is pending and interrupts allow it.
+ *
+ * Like the hardware, global interrupts are disabled while the ISR runs.
+ */
+void TWI_Simulator::service(void)
+{
+    if (this->inIsr || !this->interrupts || this->vector == NULL)  //*< The ISR can't run now.
+        return;
+
+    if ((this->twcr & ((1 << TWINT) | (1 << TWIE) | (1 << TWEN))) != ((1 << TWINT) | (1 << TWIE) | (1 << TWEN)))  //*< No interrupt pending.
+        return;
+
+    this->inIsr = 1;          //*< Entering the ISR...
+    this->mask(0);            //*< ...clears the global interrupt flag.
+    this->stats.interrupts++;
+    this->vector();           //*< Run the ISR.
+    this->mask(1);            //*< RETI sets the flag again.
+    this->inIsr = 0;
+}
+
+
+/**
+ * @brief Changes the global interrupt flag and measures how long it was cleared.
+ *
+ * @param enabled Non-zero to enable interrupts.
+ */
+void TWI_Simulator::mask(const uint8_t enabled)
+{
+    if (this->interrupts && !enabled)  //*< Interrupts get disabled.
+        this->maskedSince = this->time;
+    else if (!this->interrupts && enabled && this->time - this->maskedSince > this->stats.maxMasked)  //*< A new longest masked time.
+        this->stats.maxMasked = this->time - this->maskedSince;
+
+    this->interrupts = enabled;  //*< Store the flag.
+}
+
+
+/**
+ * @brief Checks whether the slave address registers match an address.
+ *
+ * @param address The 7-bit address a master sent, `0` for a general call.
+ *
+ * @return `1` if the peripheral acknowledges the address, `0` otherwise.
+ */
+const uint8_t TWI_Simulator::addressed(const uint8_t address)
+{
+    if ((this->twcr & ((1 << TWEN) | (1 << TWEA))) != ((1 << TWEN) | (1 << TWEA)))  //*< Not listening as slave.
+        return (0);
+
+    if (!address)                               //*< General call
+        return (this->twar & (1 << TWGCE));     //*< Only if enabled.
+
+    return (!(((this->twar >> 1) ^ address) & ~(this->twamr >> 1) & 0x7F));  //*< Masked bits don't care.
+}
+
+#endif
@@ -0,0 +1,305 @@
+#ifndef __TWI_HOST_H__
+#define __TWI_HOST_H__
+
+/* Dependecies */
+#include <stdio.h>
+#include <stdint.h>
+
+/**
+ * @brief Host build of the TWI library.
+ *
+ * Defining `TWI_HOST` replaces the AVR headers with this shim, so `TWI.cpp` compiles
+ * for the machine it is built on. The TWI peripheral is replaced by `TWI_Simulator`, a
+ * register-level model of the bus, and the `TWI0` instance is bound to it. Everything
+ * else, the ISR included, is the very same code that runs on the target.
+ *
+ * Build `TWI.cpp` and `TWI_Host.cpp` (not `TWI0.cpp`/`TWI1.cpp`) together with the host
+ * program, e.g. `g++ -std=c++11 -DTWI_HOST TWI.cpp TWI_Host.cpp main.cpp`.
+ */
+
+#ifndef F_CPU
+#define F_CPU 16000000UL
+#endif
+
+/* TWCR bits */
+#define TWINT 7
+#define TWEA  6
+#define TWSTA 5
+#define TWSTO 4
+#define TWWC  3
+#define TWEN  2
+#define TWIE  0
+
+/* TWSR bits */
+#define TWPS1 1
+#define TWPS0 0
+
+/* TWAR bits */
+#define TWGCE 0
+
+/* TWSR status codes, as in <util/twi.h> */
+#define TW_START                 0x08
+#define TW_REP_START             0x10
+#define TW_MT_SLA_ACK            0x18
+#define TW_MT_SLA_NACK           0x20
+#define TW_MT_DATA_ACK           0x28
+#define TW_MT_DATA_NACK          0x30
+#define TW_MT_ARB_LOST           0x38
+#define TW_MR_ARB_LOST           0x38
+#define TW_MR_SLA_ACK            0x40
+#define TW_MR_SLA_NACK           0x48
+#define TW_MR_DATA_ACK           0x50
+#define TW_MR_DATA_NACK          0x58
+#define TW_ST_SLA_ACK            0xA8
+#define TW_ST_ARB_LOST_SLA_ACK   0xB0
+#define TW_ST_DATA_ACK           0xB8
+#define TW_ST_DATA_NACK          0xC0
+#define TW_ST_LAST_DATA          0xC8
+#define TW_SR_SLA_ACK            0x60
+#define TW_SR_ARB_LOST_SLA_ACK   0x68
+#define TW_SR_GCALL_ACK          0x70
+#define TW_SR_ARB_LOST_GCALL_ACK 0x78
+#define TW_SR_DATA_ACK           0x80
+#define TW_SR_DATA_NACK          0x88
+#define TW_SR_GCALL_DATA_ACK     0x90
+#define TW_SR_GCALL_DATA_NACK    0x98
+#define TW_SR_STOP               0xA0
+#define TW_NO_INFO               0xF8
+#define TW_BUS_ERROR             0x00
+#define TW_READ                  1
+#define TW_WRITE                 0
+
+#define TWI_SIM_SCL     (const uint8_t)1        //< The simulated SCL pin.
+#define TWI_SIM_SDA     (const uint8_t)0        //< The simulated SDA pin.
+#define TWI_SIM_FOREVER (const uint16_t)0xFFFF  //< A line held low that no SCL pulse releases.
+
+/**
+ * @brief A simulated slave device on the bus.
+ *
+ * The devices answer the transactions `TWI0` starts as master. An address that no
+ * device claims is not acknowledged.
+ */
+typedef struct TWI_SimDevice
+{
+    uint8_t address;                    //< The 7-bit address of the device.
+    uint8_t nackAddress;                //< Non-zero to refuse the address, like a busy EEPROM.
+    uint16_t nackAfter;                 //< The number of written bytes after which data is refused, `0` to accept any.
+    uint32_t stretch;                   //< The time SCL is held low after every byte, in CPU cycles.
+    uint8_t (*read)(void);              //< Produces the next byte read by the master, `NULL` sends `0xFF`.
+    void (*write)(const uint8_t byte);  //< Consumes a byte written by the master, may be `NULL`.
+    uint32_t writeCycle;                //< The time the address is refused after a write, like an EEPROM, in CPU cycles.
+    uint64_t busyUntil;                 //< The end of the current write cycle, maintained by the simulator.
+} TWI_SimDevice;
+
+/**
+ * @brief Bus measurements of the simulator, in CPU cycles.
+ */
+typedef struct TWI_SimStats
+{
+    uint64_t busCycles;    //< Time the bus was clocking START, address, data and STOP.
+    uint64_t idleCycles;   //< Time the bus was idle between two transactions.
+    uint64_t maxIdle;      //< The longest idle gap between two transactions.
+    uint64_t waitCycles;   //< Time the foreground spent in `_delay_us()`, the blocking waits included.
+    uint64_t sleepCycles;  //< Time the foreground spent asleep in `sleep_cpu()`.
+    uint64_t maxMasked;    //< The longest time interrupts were disabled, the ISR included.
+    uint32_t interrupts;   //< The number of `isr()` invocations.
+    uint32_t transactions; //< The number of START conditions (repeated ones included).
+    uint32_t sclPulses;    //< SCL pulses clocked by software with the TWI switched off.
+    uint32_t drivenHigh;   //< Direction changes that drove a line high with the TWI switched off.
+    uint32_t floatingReads;//< Reads of a released line whose pull-up was off, with the TWI switched off.
+} TWI_SimStats;
+
+/**
+ * @brief Register-level model of the TWI peripheral and the bus behind it.
+ *
+ * Writing TWCR with TWINT set starts the bus operation the control bits select, exactly
+ * like the hardware: START/repeated START, address or data byte, or STOP. The operation
+ * takes the time the bit rate registers dictate plus any clock stretching of the device,
+ * then the status is stored in TWSR, TWINT is set and, with TWIE set and interrupts
+ * enabled, `isr()` runs. Time only passes in `_delay_us()`/`_delay_ms()` (which the
+ * blocking waits of the library call), in `sleep_cpu()` and in `run()`.
+ *
+ * An external master addressing `TWI0` as slave is played by `masterWrite()`,
+ * `masterRead()` and `masterWriteRead()`. Arbitration and multi-master traffic are not modelled.
+ * To address it while the CPU sleeps, play the master from a function set with `setWakeup()`.
+ *
+ * Faults are injected with `holdSda()`, `holdScl()` and `setStopDelay()`. While a line is
+ * held low no bus operation completes, TWSTO stays set and the input register reads the
+ * line low, so timeouts and bus recovery run like on a hung bus. The lines and the
+ * direction register are modelled for the recovery: with the TWI switched off, every
+ * release of a software-driven SCL counts as a clock pulse, and a line driven high or
+ * read without its pull-up is counted as a fault of the open-drain emulation.
+ */
+class TWI_Simulator
+{
+    public:
+        TWI_Simulator(void (*vector)(void));
+
+        void attach (TWI_SimDevice* devices, const uint8_t count);
+        void run    (const uint32_t microseconds);
+        void sleep  (const uint32_t microseconds);
+        void advance(const uint64_t cycles);
+        const uint64_t now(void);
+
+        const uint16_t masterWrite(const uint8_t address, const uint8_t* data, const uint16_t size);
+        const uint16_t masterRead (const uint8_t address, uint8_t* data, const uint16_t size);
+        const uint16_t masterWriteRead(const uint8_t address, const uint8_t* data, const uint16_t size, uint8_t* destination, const uint16_t length);
+
+        void snapshot  (TWI_SimStats* stats);
+        void resetStats(void);
+
+        void holdSda     (const uint16_t pulses);
+        void holdScl     (const uint8_t held);
+        void setStopDelay(const uint32_t cycles);
+        void setWakeup   (void (*function)(void));
+
+        void setInterrupts(const uint8_t enabled);
+        const uint8_t getInterrupts(void);
+
+        const uint8_t control(void);
+        void control(const uint8_t value);
+        const uint8_t direction(void);
+        void direction(const uint8_t value);
+        const uint8_t pins(void);
+
+        volatile uint8_t twbr;   //< The bit rate register.
+        volatile uint8_t twsr;   //< The status register, status code and prescaler bits.
+        volatile uint8_t twar;   //< The slave address register.
+        volatile uint8_t twdr;   //< The data register.
+        volatile uint8_t twamr;  //< The slave address mask register.
+        volatile uint8_t port;   //< The output register of the SCL/SDA pins.
+
+    private:
+        void (*vector)(void);     //< The interrupt vector, the `isr()` of the bound instance.
+        TWI_SimDevice* devices;   //< The simulated slave devices.
+        uint8_t deviceCount;      //< The number of simulated slave devices.
+        TWI_SimDevice* device;    //< The device addressed by the current transaction, NULL if none.
+        uint8_t twcr;             //< The control register.
+        uint8_t ddr;              //< The direction register of the SCL/SDA pins.
+        uint16_t sdaHold;         //< The SCL pulses until a slave releases SDA, `TWI_SIM_FOREVER` if never, `0` if released.
+        uint8_t sclHold;          //< Flag indicating whether a slave holds SCL low.
+        uint32_t stopDelay;       //< The time every STOP takes to complete, in CPU cycles.
+        void (*wakeup)(void);     //< The event arriving once the CPU next falls asleep, NULL if none.
+        uint8_t stopping;         //< Flag indicating whether a STOP is in progress, TWSTO still set.
+        uint8_t starting;         //< Flag indicating whether a START waits for the STOP in progress.
+        uint64_t stopDue;         //< The time the STOP in progress completes.
+        uint64_t maskedSince;     //< The time interrupts were last disabled.
+        uint8_t interrupts;       //< The global interrupt enable flag.
+        uint8_t inIsr;            //< Flag preventing the ISR from being re-entered.
+        uint8_t phase;            //< What the next TWCR write with TWINT clocks out as master.
+        uint8_t owned;            //< Flag indicating whether the bus is held as master.
+        uint8_t joining;          //< Flag indicating whether the external master holds SDA low for a repeated START.
+        uint16_t written;         //< The number of bytes written to the addressed device.
+        uint8_t pending;          //< Flag indicating whether a bus operation is in progress.
+        uint8_t pendingStatus;    //< The status the operation in progress ends with.
+        uint64_t due;             //< The time the operation in progress ends.
+        uint64_t length;          //< The duration of the operation in progress, to resume it once a held line is released.
+        uint64_t time;            //< The current time in CPU cycles.
+        uint64_t released;        //< The time the bus was last released, for the idle gaps.
+        uint8_t active;           //< Flag indicating whether the bus was used since the last reset of the measurements.
+        TWI_SimStats stats;       //< The bus measurements.
+
+        const uint32_t bit(void);  //< The duration of one SCL period.
+        void schedule(const uint8_t status, const uint64_t cycles); //< Starts a bus operation.
+        void start(void);          //< Clocks a START or repeated START condition.
+        void stopped(void);        //< Completes the STOP in progress.
+        void raise(const uint8_t status, const uint64_t cycles);    //< Runs a bus operation of an external master to its end.
+        void service(void);        //< Runs the ISR if an interrupt is pending.
+        const uint8_t stuck(void); //< Checks whether a line is held low.
+        void resume(void);         //< Stalls or resumes the bus operations after a line changed.
+        void mask(const uint8_t enabled); //< Changes the global interrupt flag and measures the masked time.
+        const uint8_t addressed(const uint8_t address); //< Checks whether the slave address registers match an address.
+};
+
+extern TWI_Simulator TWI_Sim;
+
+/**
+ * @brief Saves and disables interrupts for the scope of an `ATOMIC_BLOCK`.
+ */
+class TWI_HostAtomic
+{
+    public:
+        TWI_HostAtomic(void) : state(TWI_Sim.getInterrupts()), pass(1) { TWI_Sim.setInterrupts(0); }
+        ~TWI_HostAtomic(void) { TWI_Sim.setInterrupts(this->state); }
+        const uint8_t once(void) { return (this->pass ? this->pass-- : 0); }
+
+    private:
+        const uint8_t state;  //< The interrupt flag to restore.
+        uint8_t pass;         //< Flag letting the block body run exactly once.
+};
+
+#define ATOMIC_FORCEON      0
+#define ATOMIC_RESTORESTATE 0
+#define ATOMIC_BLOCK(type)  for (TWI_HostAtomic _atomic; _atomic.once(); )
+#define cli()               TWI_Sim.setInterrupts(0)
+#define sei()               TWI_Sim.setInterrupts(1)
+#define _delay_us(us)       TWI_Sim.run(us)
+#define _delay_ms(ms)       TWI_Sim.run((ms) * 1000UL)
+#define TCNT1               ((uint16_t)TWI_Sim.now())
+#define SLEEP_MODE_IDLE     0
+#define SLEEP_MODE_PWR_DOWN 2
+#define set_sleep_mode(mode)
+#define sleep_enable()
+#define sleep_disable()
+#define sleep_cpu()         TWI_Sim.sleep(TWI_SLEEP_TICK)
+#define PROGMEM
+#define pgm_read_byte(address) (*(const uint8_t*)(address))
+#define pgm_read_word(address) (*(const uint16_t*)(address))
+#define pgm_read_ptr(address)  (*(void* const*)(address))
+
+/**
+ * @brief The direction register of the simulated SCL/SDA pins.
+ *
+ * Writes go through `TWI_Simulator::direction()` so releasing a driven SCL counts as a
+ * clock pulse.
+ */
+struct TWI_HostDirection
+{
+    operator uint8_t(void) const { return (TWI_Sim.direction()); }
+    const TWI_HostDirection& operator=(const uint8_t value) const { TWI_Sim.direction(value); return (*this); }
+    const TWI_HostDirection& operator|=(const uint8_t value) const { TWI_Sim.direction(TWI_Sim.direction() | value); return (*this); }
+    const TWI_HostDirection& operator&=(const uint8_t value) const { TWI_Sim.direction(TWI_Sim.direction() & value); return (*this); }
+};
+
+/**
+ * @brief The input register of the simulated SCL/SDA pins.
+ *
+ * Reads return the level of the lines: high unless driven low as an output or held low
+ * by a device.
+ */
+struct TWI_HostInput
+{
+    operator uint8_t(void) const { return (TWI_Sim.pins()); }
+};
+
+/**
+ * @brief The TWI control register of the simulator.
+ *
+ * Writes go through `TWI_Simulator::control()` so clearing TWINT starts the next bus
+ * operation, reads return the current control bits and flags.
+ */
+struct TWI_HostControl
+{
+    operator uint8_t(void) const { return (TWI_Sim.control()); }
+    const TWI_HostControl& operator=(const uint8_t value) const { TWI_Sim.control(value); return (*this); }
+};
+
+/**
+ * @brief Register set of the simulated TWI peripheral.
+ */
+struct TWI_HostRegisters
+{
+    static volatile uint8_t& twbr (void) { return (TWI_Sim.twbr);  } //< The simulated TWI bit rate register.
+    static volatile uint8_t& twsr (void) { return (TWI_Sim.twsr);  } //< The simulated TWI status register.
+    static volatile uint8_t& twar (void) { return (TWI_Sim.twar);  } //< The simulated TWI address register.
+    static volatile uint8_t& twdr (void) { return (TWI_Sim.twdr);  } //< The simulated TWI data register.
+    static TWI_HostControl   twcr (void) { return (TWI_HostControl()); } //< The simulated TWI control register.
+    static volatile uint8_t& twamr(void) { return (TWI_Sim.twamr); } //< The simulated TWI address mask register.
+    static volatile uint8_t& port (void) { return (TWI_Sim.port);  } //< The simulated output register of the SCL/SDA pins.
+    static TWI_HostDirection ddr  (void) { return (TWI_HostDirection()); } //< The simulated direction register of the SCL/SDA pins.
+    static TWI_HostInput     pin  (void) { return (TWI_HostInput());     } //< The simulated input register of the SCL/SDA pins.
+    static const uint8_t SCL = TWI_SIM_SCL;                          //< The simulated SCL pin.
+    static const uint8_t SDA = TWI_SIM_SDA;                          //< The simulated SDA pin.
+};
+
+#endif
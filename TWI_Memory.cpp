@@ -0,0 +1,142 @@
+/* Dependencies */
+#include "TWI_Memory.h"
+
+
+/**
+ * @brief Writes any number of bytes to the memory.
+ *
+ * The data is split on page boundaries, each page is written as one transaction that
+ * first ACK-polls the device until a previous write cycle has ended. The call blocks until
+ * every page, the last one included, has been acknowledged or has failed; each page waits
+ * at most `bus.getTimeout()` without bus progress. Only the write cycle of the last page
+ * may still run on return, the next access polls for its end.
+ *
+ * @param location The memory address of the first byte.
+ * @param data Pointer to the data to write.
+ * @param size The number of bytes to write.
+ *
+ * @return The number of bytes written, less than `size` if a page failed (see `getStatus()`), 
+ *         `0` if called again while a transaction of the device is still in flight.
+ */
+template <class BUS>
+const uint16_t TWI_Memory<BUS>::write(const uint16_t location, const void* data, const uint16_t size)
+{
+    const uint8_t* bytes = (const uint8_t*)data;  /**< The next bytes to write. */
+    uint16_t written = 0;  /**< The number of bytes written so far. */
+
+    if (!this->transfer.done)  /**< The last transaction is still owned by the bus. */
+        return (0);
+
+    while (written < size)  /**< Page by page. */
+    {
+        const uint16_t at = location + written;  /**< The memory address of this page's first byte. */
+        uint16_t chunk = this->pageSize - (at % this->pageSize);  /**< Up to the end of the page... */
+        if (chunk > size - written)  /**< ...or of the data. */
+            chunk = size - written;
+
+        this->prepare(at);  /**< Send the memory address first... */
+        this->transfer.txNext = bytes + written;  /**< ...then the bytes straight from the caller. */
+        this->transfer.txNextLength = chunk;
+        this->transfer.rxData = NULL;
+        this->transfer.rxLength = 0;
+
+        if (!this->bus.enqueue(&this->transfer))  /**< Hand the page to the ISR. */
+            break;
+        if (this->bus.wait(&this->transfer, this->bus.getTimeout()) != TW_MT_DATA_ACK)  /**< Every byte must be acknowledged. */
+            break;
+
+        written += chunk;  /**< The page is in. */
+    }
+
+    return (written);  /**< Return the number of bytes written. */
+}
+
+
+/**
+ * @brief Reads any number of bytes from the memory.
+ *
+ * The read is a single transaction: the memory address is written, then the device
+ * streams the bytes across page boundaries after a repeated START. A pending write cycle
+ * is ACK-polled first.
+ *
+ * @param location The memory address of the first byte.
+ * @param destination Pointer to the destination of the data.
+ * @param length The number of bytes to read.
+ *
+ * @return The number of bytes read, `0` if the read failed or a transaction of the device is still in flight.
+ */
+template <class BUS>
+const uint16_t TWI_Memory<BUS>::read(const uint16_t location, void* destination, const uint16_t length)
+{
+    if (!length || !this->transfer.done)  /**< Nothing to read, or the last transaction is still owned by the bus. */
+        return (0);
+
+    this->prepare(location);  /**< Write the memory address... */
+    this->transfer.txNext = NULL;
+    this->transfer.txNextLength = 0;
+    this->transfer.rxData = (uint8_t*)destination;  /**< ...and read straight into the caller's memory. */
+    this->transfer.rxLength = length;
+
+    if (!this->bus.enqueue(&this->transfer))  /**< Hand the read to the ISR. */
+        return (0);
+    if (this->bus.wait(&this->transfer, this->bus.getTimeout()) != TW_MR_DATA_NACK)  /**< The last byte ends with a NACK. */
+        return (0);
+
+    return (this->transfer.count);  /**< Return the number of bytes read. */
+}
+
+
+/**
+ * @brief Returns the TWI status of the last page written or read.
+ *
+ * @return The final TWI status code.
+ */
+template <class BUS>
+const uint8_t TWI_Memory<BUS>::getStatus(void)
+{
+    return (this->transfer.status);  /**< Return the status of the last transaction. */
+}
+
+
+/**
+ * @brief Addresses a memory location.
+ *
+ * Fills the address header and the device address, including the upper address bits of
+ * devices with a single address byte, and enables ACK polling.
+ *
+ * @param location The memory address.
+ */
+template <class BUS>
+void TWI_Memory<BUS>::prepare(const uint16_t location)
+{
+    if (this->addressBytes > 1)  //*< Two address bytes, high byte first.
+    {
+        this->header[0] = location >> 8;
+        this->header[1] = location & 0xFF;
+        this->transfer.address = this->address;
+    }
+    else  //*< One address byte, the upper bits select the block.
+    {
+        this->header[0] = location & 0xFF;
+        this->transfer.address = this->address | ((location >> 8) & 0x07);
+    }
+
+    this->transfer.txData = this->header;                //*< The address goes first.
+    this->transfer.txLength = this->addressBytes > 1 ? 2 : 1;
+    this->transfer.ackPolls = TWI_MEMORY_ACK_POLLS;      //*< Wait out a write cycle on the bus.
+}
+
+
+/**
+ * @brief Explicit instantiations of the memory layer for every available bus.
+ */
+#if defined(__AVR_ATmega328__)  || \
+    defined(__AVR_ATmega328P__) || \
+    defined(__AVR_ATmega328PB__) || \
+    defined(TWI_HOST)
+    template class TWI_Memory<TWI0_Bus>;
+#endif
+
+#if defined(__AVR_ATmega328PB__)
+    template class TWI_Memory<TWI1_Bus>;
+#endif
@@ -0,0 +1,57 @@
+#ifndef __TWI_MEMORY_H__
+#define __TWI_MEMORY_H__
+
+/* Dependecies */
+#include "TWI.h"
+
+#ifndef TWI_MEMORY_ACK_POLLS
+#define TWI_MEMORY_ACK_POLLS  (const uint16_t)1000
+#endif
+
+/**
+ * @brief Bulk transfers to and from an I2C EEPROM or FRAM.
+ *
+ * Writes of any length are split on page boundaries. Every page is one transaction
+ * that sends the memory address followed by the caller's bytes straight from their
+ * memory, so neither is limited by the bus buffer. The end of a write cycle is detected
+ * by ACK polling: a busy device refuses its address and the ISR addresses it again
+ * until it answers (at most `TWI_MEMORY_ACK_POLLS` times), instead of waiting a fixed
+ * delay. The limit is a count of address attempts, not a duration: each one takes about
+ * 11 SCL periods, so 1000 polls last some 28 ms at 400 kHz and 110 ms at 100 kHz. Reads
+ * of any length are a single transaction.
+ *
+ * Devices with one address byte and more than 256 bytes (24C04/08/16) take the upper
+ * address bits in their device address; this is handled as well. For FRAM, which has
+ * no write cycle, use the size of the whole device as page size.
+ *
+ * @code
+ * TWI_Memory<TWI0_Bus> eeprom(TWI0, 0x50, 64, 2);  // 24C256: 64 byte pages, 2 address bytes.
+ *
+ * eeprom.write(0x0100, log, sizeof(log));
+ * eeprom.read(0x0000, copy, sizeof(copy));
+ * @endcode
+ */
+template <class BUS>
+class TWI_Memory
+{
+    public:
+        constexpr TWI_Memory(BUS& bus, const uint8_t address, const uint16_t pageSize, const uint8_t addressBytes) :
+            bus(bus), address(address), pageSize(pageSize), addressBytes(addressBytes), header(),
+            transfer(TWI_TRANSACTION_IDLE) {}
+
+        const uint16_t write(const uint16_t location, const void* data, const uint16_t size);
+        const uint16_t read (const uint16_t location, void* destination, const uint16_t length);
+        const uint8_t getStatus(void);
+
+    private:
+        BUS& bus;                  //< The bus the device hangs on.
+        uint8_t address;           //< The 7-bit address of the device.
+        uint16_t pageSize;         //< The size of a write page in bytes.
+        uint8_t addressBytes;      //< The number of memory address bytes, 1 or 2.
+        uint8_t header[2];         //< The memory address sent ahead of the data.
+        TWI_Transaction transfer;  //< The transaction of the current page or read.
+
+        void prepare(const uint16_t location); //< Addresses a memory location.
+};
+
+#endif
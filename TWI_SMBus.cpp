@@ -0,0 +1,266 @@
+/* Dependencies */
+#include "TWI_SMBus.h"
+
+
+/**
+ * @brief Enables or disables Packet Error Checking for the following commands.
+ *
+ * @param enabled `1` to append and check the PEC, `0` for plain commands.
+ */
+template <class BUS>
+void TWI_SMBus<BUS>::setPec(const uint8_t enabled)
+{
+    this->pec = enabled ? TWI_SMBUS_PEC : 0;  /**< Picked up by the next command. */
+}
+
+
+/**
+ * @brief Quick Command: sends only the address, the R/W bit is the data.
+ *
+ * Quick commands carry no PEC. The TWI can't stop right after SLA+R, so a read quick
+ * command clocks in one byte and NACKs it.
+ *
+ * @param address The 7-bit address of the device.
+ * @param read `1` to send the R/W bit set, `0` to send it cleared.
+ *
+ * @return The final TWI status.
+ */
+template <class BUS>
+const uint8_t TWI_SMBus<BUS>::quickCommand(const uint8_t address, const uint8_t read)
+{
+    return (this->run(address, 0, NULL, 0, read ? this->reply : NULL, read ? 1 : 0, 0));  /**< An empty write, or a single byte read. */
+}
+
+
+/**
+ * @brief Send Byte: writes a single byte without a command code.
+ *
+ * @param address The 7-bit address of the device.
+ * @param byte The byte to send.
+ *
+ * @return The final TWI status.
+ */
+template <class BUS>
+const uint8_t TWI_SMBus<BUS>::sendByte(const uint8_t address, const uint8_t byte)
+{
+    this->header[0] = byte;
+    return (this->run(address, 1, NULL, 0, NULL, 0, this->pec));  /**< The byte, then the PEC. */
+}
+
+
+/**
+ * @brief Receive Byte: reads a single byte without a command code.
+ *
+ * @param address The 7-bit address of the device.
+ * @param byte Pointer to the destination of the byte.
+ *
+ * @return The final TWI status.
+ */
+template <class BUS>
+const uint8_t TWI_SMBus<BUS>::receiveByte(const uint8_t address, uint8_t* byte)
+{
+    return (this->run(address, 0, NULL, 0, byte, 1, this->pec));  /**< The byte, then the PEC. */
+}
+
+
+/**
+ * @brief Write Byte: writes a byte to a command code.
+ *
+ * @param address The 7-bit address of the device.
+ * @param command The command code.
+ * @param byte The byte to write.
+ *
+ * @return The final TWI status.
+ */
+template <class BUS>
+const uint8_t TWI_SMBus<BUS>::writeByte(const uint8_t address, const uint8_t command, const uint8_t byte)
+{
+    this->header[0] = command;
+    this->header[1] = byte;
+    return (this->run(address, 2, NULL, 0, NULL, 0, this->pec));  /**< Command and byte, then the PEC. */
+}
+
+
+/**
+ * @brief Write Word: writes a word to a command code, low byte first.
+ *
+ * @param address The 7-bit address of the device.
+ * @param command The command code.
+ * @param word The word to write.
+ *
+ * @return The final TWI status.
+ */
+template <class BUS>
+const uint8_t TWI_SMBus<BUS>::writeWord(const uint8_t address, const uint8_t command, const uint16_t word)
+{
+    this->header[0] = command;
+    this->header[1] = word & 0xFF;  /**< SMBus words are little-endian. */
+    this->header[2] = word >> 8;
+    return (this->run(address, 3, NULL, 0, NULL, 0, this->pec));  /**< Command and word, then the PEC. */
+}
+
+
+/**
+ * @brief Read Byte: reads a byte from a command code.
+ *
+ * @param address The 7-bit address of the device.
+ * @param command The command code.
+ * @param byte Pointer to the destination of the byte.
+ *
+ * @return The final TWI status.
+ */
+template <class BUS>
+const uint8_t TWI_SMBus<BUS>::readByte(const uint8_t address, const uint8_t command, uint8_t* byte)
+{
+    this->header[0] = command;
+    return (this->run(address, 1, NULL, 0, byte, 1, this->pec));  /**< Command, repeated START, byte and PEC. */
+}
+
+
+/**
+ * @brief Read Word: reads a word from a command code, low byte first.
+ *
+ * @param address The 7-bit address of the device.
+ * @param command The command code.
+ * @param word Pointer to the destination of the word, only written on success.
+ *
+ * @return The final TWI status.
+ */
+template <class BUS>
+const uint8_t TWI_SMBus<BUS>::readWord(const uint8_t address, const uint8_t command, uint16_t* word)
+{
+    this->header[0] = command;
+    const uint8_t status = this->run(address, 1, NULL, 0, this->reply, 2, this->pec);  /**< Command, repeated START, word and PEC. */
+
+    if (status == TW_MR_DATA_NACK)  /**< Assemble the little-endian word. */
+        *word = this->reply[0] | ((uint16_t)this->reply[1] << 8);
+
+    return (status);
+}
+
+
+/**
+ * @brief Block Write: writes a block of bytes to a command code.
+ *
+ * The bytes are sent straight from the caller's memory after the command code and the
+ * block count.
+ *
+ * @param address The 7-bit address of the device.
+ * @param command The command code.
+ * @param data Pointer to the bytes to write.
+ * @param size The number of bytes to write, the block count.
+ *
+ * @return The final TWI status.
+ */
+template <class BUS>
+const uint8_t TWI_SMBus<BUS>::blockWrite(const uint8_t address, const uint8_t command, const void* data, const uint8_t size)
+{
+    this->header[0] = command;
+    this->header[1] = size;  /**< The block count. */
+    return (this->run(address, 2, data, size, NULL, 0, this->pec));  /**< Command, count and bytes, then the PEC. */
+}
+
+
+/**
+ * @brief Block Read: reads a block of bytes from a command code.
+ *
+ * The ISR takes the length of the read from the block count the device sends first; a
+ * block larger than the destination is cut short after the bytes that fit and returns
+ * `TWI_ERROR_TRUNCATED`.
+ *
+ * @param address The 7-bit address of the device.
+ * @param command The command code.
+ * @param destination Pointer to the destination of the bytes.
+ * @param length The size of the destination, updated with the number of bytes read.
+ *
+ * @return The final TWI status.
+ */
+template <class BUS>
+const uint8_t TWI_SMBus<BUS>::blockRead(const uint8_t address, const uint8_t command, void* destination, uint8_t* length)
+{
+    this->header[0] = command;
+    const uint8_t status = this->run(address, 1, NULL, 0, destination, *length, this->pec | TWI_SMBUS_BLOCK);  /**< Command, repeated START, count, bytes and PEC. */
+
+    *length = this->transfer.count;  /**< Report the bytes actually read. */
+
+    return (status);
+}
+
+
+/**
+ * @brief Block Write-Block Read Process Call: writes a block and reads the answer block.
+ *
+ * @param address The 7-bit address of the device.
+ * @param command The command code.
+ * @param data Pointer to the bytes to write.
+ * @param size The number of bytes to write.
+ * @param destination Pointer to the destination of the answer.
+ * @param length The size of the destination, updated with the number of bytes read.
+ *
+ * @return The final TWI status.
+ */
+template <class BUS>
+const uint8_t TWI_SMBus<BUS>::blockProcessCall(const uint8_t address, const uint8_t command, const void* data, const uint8_t size, void* destination, uint8_t* length)
+{
+    this->header[0] = command;
+    this->header[1] = size;  /**< The block count. */
+    const uint8_t status = this->run(address, 2, data, size, destination, *length, this->pec | TWI_SMBUS_BLOCK);  /**< Both blocks in one transaction, one PEC at the end. */
+
+    *length = this->transfer.count;  /**< Report the bytes actually read. */
+
+    return (status);
+}
+
+
+/**
+ * @brief Runs a command as a single transaction and waits for it.
+ *
+ * A previous command that is neither done nor dequeued is never touched, the call fails 
+ * instead.
+ *
+ * @param address The 7-bit address of the device.
+ * @param size The number of header bytes to write.
+ * @param data The bytes written after the header, `NULL` if none.
+ * @param dataSize The number of bytes written after the header.
+ * @param destination The destination of the bytes read, `NULL` if none.
+ * @param length The number of bytes to read.
+ * @param smbus The SMBus flags of the transaction.
+ *
+ * @return The final TWI status, `0` if the previous command is still pending or the 
+ * transaction could not be queued.
+ */
+template <class BUS>
+const uint8_t TWI_SMBus<BUS>::run(const uint8_t address, const uint8_t size, const void* data, const uint8_t dataSize, void* destination, const uint16_t length, const uint8_t smbus)
+{
+    if (!this->transfer.done)  //*< The ISR still owns the previous command.
+        return (0);
+
+    this->transfer.address = address;                    //*< Address the device...
+    this->transfer.txData = this->header;                //*< ...write the header...
+    this->transfer.txLength = size;
+    this->transfer.txNext = (const uint8_t*)data;        //*< ...and the caller's bytes...
+    this->transfer.txNextLength = dataSize;
+    this->transfer.rxData = (uint8_t*)destination;       //*< ...then read straight into the caller's memory.
+    this->transfer.rxLength = length;
+    this->transfer.smbus = smbus;
+
+    if (!this->bus.enqueue(&this->transfer))  //*< Hand the command to the ISR.
+        return (0);
+
+    return (this->bus.wait(&this->transfer, this->bus.getTimeout()));  //*< Wait for its final status.
+}
+
+
+/**
+ * @brief Explicit instantiations of the SMBus layer for every available bus.
+ */
+#if defined(__AVR_ATmega328__)  || \
+    defined(__AVR_ATmega328P__) || \
+    defined(__AVR_ATmega328PB__) || \
+    defined(TWI_HOST)
+    template class TWI_SMBus<TWI0_Bus>;
+#endif
+
+#if defined(__AVR_ATmega328PB__)
+    template class TWI_SMBus<TWI1_Bus>;
+#endif
@@ -0,0 +1,61 @@
+#ifndef __TWI_SMBUS_H__
+#define __TWI_SMBUS_H__
+
+/* Dependecies */
+#include "TWI.h"
+
+/**
+ * @brief SMBus commands on top of a TWI bus, with optional Packet Error Checking.
+ *
+ * Every command is a single transaction run by the ISR. With PEC enabled, the CRC-8 is
+ * computed byte by byte while the hardware shifts the bytes, appended to writes and
+ * checked at the end of reads; a mismatch returns `TWI_ERROR_PEC`. Block reads take their
+ * length from the block count the device sends first, on the fly; a block larger than the
+ * destination returns `TWI_ERROR_TRUNCATED`.
+ *
+ * Every command returns the final TWI status: `TW_MT_DATA_ACK` for a successful write,
+ * `TW_MR_DATA_NACK` for a successful read.
+ *
+ * @code
+ * TWI_SMBus<TWI0_Bus> smbus(TWI0, 1);  // With PEC.
+ *
+ * uint16_t voltage;
+ * uint8_t name[32];
+ * uint8_t length = sizeof(name);
+ *
+ * smbus.readWord(0x0B, 0x09, &voltage);            // Smart battery: Voltage().
+ * smbus.blockRead(0x0B, 0x21, name, &length);      // Smart battery: DeviceName().
+ * @endcode
+ */
+template <class BUS>
+class TWI_SMBus
+{
+    public:
+        constexpr TWI_SMBus(BUS& bus, const uint8_t pec) :
+            bus(bus), pec(pec ? TWI_SMBUS_PEC : 0), header(), reply(),
+            transfer(TWI_TRANSACTION_IDLE) {}
+
+        void setPec(const uint8_t enabled);
+
+        const uint8_t quickCommand(const uint8_t address, const uint8_t read);
+        const uint8_t sendByte    (const uint8_t address, const uint8_t byte);
+        const uint8_t receiveByte (const uint8_t address, uint8_t* byte);
+        const uint8_t writeByte   (const uint8_t address, const uint8_t command, const uint8_t byte);
+        const uint8_t writeWord   (const uint8_t address, const uint8_t command, const uint16_t word);
+        const uint8_t readByte    (const uint8_t address, const uint8_t command, uint8_t* byte);
+        const uint8_t readWord    (const uint8_t address, const uint8_t command, uint16_t* word);
+        const uint8_t blockWrite  (const uint8_t address, const uint8_t command, const void* data, const uint8_t size);
+        const uint8_t blockRead   (const uint8_t address, const uint8_t command, void* destination, uint8_t* length);
+        const uint8_t blockProcessCall(const uint8_t address, const uint8_t command, const void* data, const uint8_t size, void* destination, uint8_t* length);
+
+    private:
+        BUS& bus;                  //< The bus the devices hang on.
+        uint8_t pec;               //< `TWI_SMBUS_PEC` if PEC is used, `0` otherwise.
+        uint8_t header[3];         //< The command code and the bytes written with it.
+        uint8_t reply[2];          //< The bytes of a byte or word reply.
+        TWI_Transaction transfer;  //< The transaction of the current command.
+
+        const uint8_t run(const uint8_t address, const uint8_t size, const void* data, const uint8_t dataSize, void* destination, const uint16_t length, const uint8_t smbus); //< Runs a command as one transaction.
+};
+
+#endif
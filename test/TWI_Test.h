@@ -0,0 +1,27 @@
+#ifndef __TWI_TEST_H__
+#define __TWI_TEST_H__
+
+/* Dependecies */
+#include <stdio.h>
+#include "TWI.h"
+
+/**
+ * @brief Minimal checks for the host tests.
+ *
+ * Every test is a program of its own built with `TWI_HOST` against the simulator, see
+ * `run.sh`. A failed check prints its location and expression and makes the program
+ * exit with a non-zero status.
+ */
+static unsigned TWI_TestFailures = 0;  //< The number of failed checks.
+
+#define TWI_CHECK(condition) \
+    do { if (!(condition)) { TWI_TestFailures++; printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #condition); } } while (0)
+
+#define TWI_CHECK_EQUAL(actual, expected) \
+    do { const long _actual = (long)(actual), _expected = (long)(expected); \
+         if (_actual != _expected) { TWI_TestFailures++; printf("%s:%d: check failed: %s == %s (0x%02lx != 0x%02lx)\n", __FILE__, __LINE__, #actual, #expected, _actual, _expected); } } while (0)
+
+#define TWI_TEST_RESULT() \
+    (printf("%s: %s\n", __FILE__, TWI_TestFailures ? "FAILED" : "passed"), TWI_TestFailures ? 1 : 0)
+
+#endif
@@ -0,0 +1,121 @@
+/* Dependencies */
+#include <stdio.h>
+#include "TWI.h"
+
+/**
+ * @brief Bus utilization, idle gaps and foreground CPU time of common transfer patterns.
+ *
+ * Every pattern runs against the simulator at 400 kHz, 16 MHz, and prints one line of
+ * `TWI_SimStats`, times in CPU cycles. Built and run by `run.sh bench`.
+ */
+
+#define BENCH_ROUNDS (const uint8_t)32  //< The number of transactions per pattern.
+
+static uint8_t register_read(void) { return (0x42); }
+static uint8_t slaveData[8];    //< The bytes the slave received.
+static uint8_t slaveCount;      //< The number of bytes the slave received.
+
+static void slave_rx(const TWI0_Bus::length_t size)
+{
+    for (slaveCount = 0; slaveCount < size && slaveCount < sizeof(slaveData); slaveCount++)
+        slaveData[slaveCount] = TWI0.read();
+}
+
+static void slave_tx(void)
+{
+    TWI0.write(slaveData, slaveCount);
+}
+
+static uint64_t started;  //< The time the current pattern started.
+
+static void begin(void)
+{
+    TWI_Sim.resetStats();
+    started = TWI_Sim.now();
+}
+
+static void report(const char* pattern)
+{
+    TWI_SimStats stats;
+    TWI_Sim.snapshot(&stats);
+    const uint64_t elapsed = TWI_Sim.now() - started;
+
+    printf("%-26s %9llu %5.1f%% %9llu %7llu %9llu %9llu %6lu %4lu\n", pattern,
+           (unsigned long long)elapsed,
+           elapsed ? 100.0 * stats.busCycles / elapsed : 0.0,
+           (unsigned long long)stats.idleCycles,
+           (unsigned long long)stats.maxIdle,
+           (unsigned long long)stats.waitCycles,
+           (unsigned long long)stats.sleepCycles,
+           (unsigned long)stats.interrupts,
+           (unsigned long)stats.transactions);
+}
+
+int main(void)
+{
+    TWI_SimDevice devices[2] =
+    {
+        {0x50, 0, 0, 0, NULL, NULL, 0, 0},
+        {0x1E, 0, 0, 0, register_read, NULL, 0, 0},
+    };
+    uint8_t data[32] = {0};
+    uint8_t sample[6];
+    TWI_Transaction queued[BENCH_ROUNDS];
+
+    TWI_Sim.attach(devices, 2);
+    TWI0.begin(TWI_FAST_MODE);
+
+    printf("%-26s %9s %6s %9s %7s %9s %9s %6s %4s\n", "pattern", "elapsed", "bus", "idle", "maxIdle", "wait", "sleep", "irqs", "txns");
+
+    begin();
+    for (uint8_t i = 0; i < BENCH_ROUNDS; i++)
+        TWI0.transmit(0x50, data, 1);
+    report("single-byte, blocking");
+
+    begin();
+    for (uint8_t i = 0; i < BENCH_ROUNDS; i++)
+    {
+        queued[i] = TWI_Transaction{0x50, data, 1};
+        while (!TWI0.enqueue(&queued[i]))  /**< The queue is full, let the bus drain it. */
+        {
+            TWI0.poll();  /**< In polling mode nothing moves without it. */
+            TWI_Sim.run(1);
+        }
+    }
+    TWI0.wait(&queued[BENCH_ROUNDS - 1], TWI_DEFAULT_TIMEOUT);
+    report("single-byte, queued");
+
+    begin();
+    for (uint8_t i = 0; i < BENCH_ROUNDS; i++)
+        TWI0.transmit(0x50, data, sizeof(data));
+    report("32-byte burst, blocking");
+
+    begin();
+    for (uint8_t i = 0; i < BENCH_ROUNDS; i++)
+    {
+        TWI0.startTransmission(0x50, data, sizeof(data));
+        while (TWI0.isBusy())  /**< The foreground sleeps through the transfer. */
+            TWI_Sim.sleep(1000);
+    }
+    report("32-byte burst, sleeping");
+
+    begin();
+    for (uint8_t i = 0; i < BENCH_ROUNDS; i++)
+        TWI0.writeThenRead(0x1E, data, 1, sample, sizeof(sample));
+    report("register read 1+6");
+
+    TWI0.end();
+    TWI0.begin((uint8_t)0x42);
+    TWI0.setRxCallback(slave_rx);
+    TWI0.setTxCallback(slave_tx);
+
+    begin();
+    for (uint8_t i = 0; i < BENCH_ROUNDS; i++)
+    {
+        TWI_Sim.masterWrite(0x42, data, 4);
+        TWI_Sim.masterRead(0x42, sample, 4);
+    }
+    report("slave response 4+4");
+
+    return (0);
+}
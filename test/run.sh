@@ -0,0 +1,34 @@
+#!/bin/sh
+#
+# Builds every host test against the TWI simulator and runs it.
+#
+#   test/run.sh                              # The default configuration.
+#   CXXFLAGS=-DTWI_INSTRUMENTATION test/run.sh  # Any other one.
+#   test/run.sh bench                        # The tests, then the benchmark.
+#
+# Exits with a non-zero status if a test fails to build or fails a check.
+
+set -e
+
+cd "$(dirname "$0")"
+out="${TMPDIR:-/tmp}/twi-test"
+mkdir -p "$out"
+
+flags="-std=gnu++11 -Wall -Wextra -Wno-ignored-qualifiers -Wno-missing-field-initializers -DTWI_HOST -I.. -I. $CXXFLAGS"
+sources="../TWI.cpp ../TWI_Host.cpp ../TWI_Memory.cpp ../TWI_SMBus.cpp ../TWI_Dispatcher.cpp"
+failed=0
+
+for test in test_*.cpp
+do
+    name="${test%.cpp}"
+    ${CXX:-g++} $flags $sources "$test" -o "$out/$name"
+    "$out/$name" || failed=1
+done
+
+if [ "$1" = bench ]
+then
+    ${CXX:-g++} $flags $sources bench.cpp -o "$out/bench"
+    "$out/bench"
+fi
+
+exit $failed
@@ -0,0 +1,66 @@
+/* Dependencies */
+#include "TWI_Test.h"
+
+/**
+ * @brief The multi-address slave: the address mask and a handler per answered address.
+ */
+
+#ifndef TWI_POLLING  /**< The external master of the simulator needs the ISR to answer it. */
+static uint8_t sensorSize;    //< The size the sensor's RX callback got.
+static uint8_t eepromSize;    //< The size the EEPROM's RX callback got.
+static uint8_t plainAddress;  //< The matched address the plain callbacks saw.
+static uint8_t plainCount;    //< The number of times a plain callback ran.
+
+static void sensor_rx(const TWI0_Bus::length_t size) { sensorSize = size; }
+static void sensor_tx(void) { TWI0.write((uint8_t)0x5E); }
+static void eeprom_rx(const TWI0_Bus::length_t size) { eepromSize = size; }
+static void plain_rx(const TWI0_Bus::length_t) { plainAddress = TWI0.getMatchedAddress(); plainCount++; }
+static void plain_tx(void) { plainAddress = TWI0.getMatchedAddress(); plainCount++; TWI0.write((uint8_t)0x9A); }
+#endif
+
+int main(void)
+{
+#ifndef TWI_POLLING
+    static const TWI0_Bus::SlaveHandler handlers[2] =
+    {
+        {0x44, sensor_rx, sensor_tx},
+        {0x50, eeprom_rx, NULL},  /**< Reads of the EEPROM fall back to the plain TX callback. */
+    };
+    const uint8_t data[3] = {1, 2, 3};
+    uint8_t reply = 0;
+
+    /* 0b10x0xxx: 0x40-0x47 and 0x50-0x57. */
+    TWI0.begin((uint8_t)0x40, (uint8_t)0x17);
+    TWI0.setRxCallback(plain_rx);
+    TWI0.setTxCallback(plain_tx);
+    TWI0.setSlaveHandlers(handlers, 2);
+
+    /* Every address with a handler goes to it... */
+    TWI_CHECK_EQUAL(TWI_Sim.masterWrite(0x44, data, 3), 3);
+    TWI_CHECK_EQUAL(sensorSize, 3);
+    TWI_CHECK_EQUAL(TWI_Sim.masterRead(0x44, &reply, 1), 1);
+    TWI_CHECK_EQUAL(reply, 0x5E);
+    TWI_CHECK_EQUAL(TWI_Sim.masterWrite(0x50, data, 2), 2);
+    TWI_CHECK_EQUAL(eepromSize, 2);
+    TWI_CHECK_EQUAL(plainCount, 0);
+
+    /* ...the missing callbacks and the other answered addresses go to the plain ones. */
+    TWI_CHECK_EQUAL(TWI_Sim.masterRead(0x50, &reply, 1), 1);
+    TWI_CHECK_EQUAL(reply, 0x9A);
+    TWI_CHECK_EQUAL(plainAddress, 0x50);
+    TWI_CHECK_EQUAL(TWI_Sim.masterWrite(0x57, data, 1), 1);
+    TWI_CHECK_EQUAL(plainAddress, 0x57);
+    TWI_CHECK_EQUAL(TWI0.getMatchedAddress(), 0x57);
+    TWI_CHECK_EQUAL(TWI_Sim.masterWrite(0x46, data, 1), 1);
+    TWI_CHECK_EQUAL(plainAddress, 0x46);
+    TWI_CHECK_EQUAL(plainCount, 3);
+    TWI_CHECK_EQUAL(sensorSize, 3);
+
+    /* Addresses differing in a bit outside the mask are not answered. */
+    TWI_CHECK_EQUAL(TWI_Sim.masterWrite(0x48, data, 1), 0);
+    TWI_CHECK_EQUAL(TWI_Sim.masterWrite(0x60, data, 1), 0);
+    TWI_CHECK_EQUAL(plainCount, 3);
+#endif
+
+    return (TWI_TEST_RESULT());
+}
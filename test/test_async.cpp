@@ -0,0 +1,134 @@
+/* Dependencies */
+#include "TWI_Test.h"
+
+/**
+ * @brief Non-blocking master transactions: completion, callback and `isBusy()`.
+ */
+
+static uint8_t written[64];    //< The bytes the device received.
+static uint8_t writtenCount;   //< The number of bytes the device received.
+static uint8_t nextRead;       //< The next byte the device sends.
+static uint8_t doneCalls;      //< The number of completion callbacks.
+static uint8_t doneStatus;     //< The status of the last completion callback.
+
+static void deviceWrite(const uint8_t byte) { written[writtenCount++] = byte; }
+static uint8_t deviceRead(void) { return (nextRead++); }
+static void onDone(const uint8_t status) { doneCalls++; doneStatus = status; }
+
+static void reset(void)
+{
+    writtenCount = 0;
+    nextRead = 0x10;
+    doneCalls = 0;
+    doneStatus = 0;
+}
+
+/**
+ * @brief Runs the simulator until the transaction has finished, at most `limit` microseconds.
+ */
+static const uint32_t settle(const uint32_t limit)
+{
+    uint32_t elapsed = 0;
+
+    while (TWI0.isBusy() && elapsed < limit)
+    {
+        TWI_Sim.run(10);
+        elapsed += 10;
+    }
+
+    return (elapsed);
+}
+
+int main(void)
+{
+    TWI_SimDevice devices[1] = {{0x50, 0, 0, 0, deviceRead, deviceWrite, 0, 0}};
+    const uint8_t data[8] = {1, 2, 3, 4, 5, 6, 7, 8};
+    uint8_t received[8] = {0};
+
+    TWI_Sim.attach(devices, 1);
+    TWI0.begin();
+    TWI0.setDoneCallback(onDone);
+
+    TWI_CHECK_EQUAL(TWI0.isBusy(), 0);  /**< Nothing in flight before the first transaction. */
+
+    /* Zero-copy write: returns at once, completes in the background. */
+    reset();
+    const uint64_t start = TWI_Sim.now();
+    TWI_CHECK_EQUAL(TWI0.startTransmission(0x50, data, sizeof(data)), 1);
+    TWI_CHECK_EQUAL(TWI_Sim.now(), start);  /**< No bus time passed in the call. */
+    TWI_CHECK_EQUAL(TWI0.isBusy(), 1);
+    TWI_CHECK_EQUAL(writtenCount, 0);
+    TWI_CHECK(settle(1000) > 0);
+    TWI_CHECK_EQUAL(TWI0.isBusy(), 0);
+    TWI_CHECK_EQUAL(TWI0.getStatus(), TW_MT_DATA_ACK);
+    TWI_CHECK_EQUAL(TWI0.received(), sizeof(data));
+    TWI_CHECK_EQUAL(writtenCount, sizeof(data));
+    TWI_CHECK_EQUAL(written[7], 8);
+    TWI_CHECK_EQUAL(doneCalls, 1);
+    TWI_CHECK_EQUAL(doneStatus, TW_MT_DATA_ACK);
+
+    /* Buffered write. */
+    reset();
+    TWI_CHECK_EQUAL(TWI0.beginTransmission(0x50), 1);
+    TWI0.write((uint8_t)0xA5);
+    TWI0.write((uint8_t)0x5A);
+    TWI_CHECK_EQUAL(TWI0.startTransmission(), 1);
+    TWI_CHECK_EQUAL(TWI0.isBusy(), 1);
+    settle(1000);
+    TWI_CHECK_EQUAL(TWI0.getStatus(), TW_MT_DATA_ACK);
+    TWI_CHECK_EQUAL(writtenCount, 2);
+    TWI_CHECK_EQUAL(written[1], 0x5A);
+    TWI_CHECK_EQUAL(doneCalls, 1);
+
+    /* Buffered read, drained with available()/read() afterwards. */
+    reset();
+    TWI_CHECK_EQUAL(TWI0.startRequest(0x50, (const uint8_t)3), 1);
+    TWI_CHECK_EQUAL(TWI0.isBusy(), 1);
+    TWI_CHECK_EQUAL(TWI0.available(), 0);  /**< Nothing to read before the request finished. */
+    settle(1000);
+    TWI_CHECK_EQUAL(TWI0.getStatus(), TW_MR_DATA_NACK);
+    TWI_CHECK_EQUAL(TWI0.available(), 3);
+    TWI_CHECK_EQUAL(TWI0.read(), 0x10);
+    TWI_CHECK_EQUAL(TWI0.read(), 0x11);
+    TWI_CHECK_EQUAL(TWI0.read(), 0x12);
+    TWI_CHECK_EQUAL(doneStatus, TW_MR_DATA_NACK);
+
+    /* Read straight into caller memory. */
+    reset();
+    TWI_CHECK_EQUAL(TWI0.startRequest(0x50, received, sizeof(received)), 1);
+    TWI_CHECK_EQUAL(TWI0.isBusy(), 1);
+    settle(1000);
+    TWI_CHECK_EQUAL(TWI0.received(), sizeof(received));
+    TWI_CHECK_EQUAL(received[0], 0x10);
+    TWI_CHECK_EQUAL(received[7], 0x17);
+
+    /* Register read as one transaction. */
+    reset();
+    TWI_CHECK_EQUAL(TWI0.startWriteThenRead(0x50, data, 1, received, 2), 1);
+    settle(1000);
+    TWI_CHECK_EQUAL(TWI0.getStatus(), TW_MR_DATA_NACK);
+    TWI_CHECK_EQUAL(writtenCount, 1);
+    TWI_CHECK_EQUAL(TWI0.received(), 2);
+    TWI_CHECK_EQUAL(doneCalls, 1);
+
+    /* A device that isn't there: the status tells, the callback still fires. */
+    reset();
+    TWI_CHECK_EQUAL(TWI0.startTransmission(0x33, data, 1), 1);
+    settle(1000);
+    TWI_CHECK_EQUAL(TWI0.isBusy(), 0);
+    TWI_CHECK_EQUAL(TWI0.getStatus(), TW_MT_SLA_NACK);
+    TWI_CHECK_EQUAL(TWI0.received(), 0);
+    TWI_CHECK_EQUAL(doneCalls, 1);
+    TWI_CHECK_EQUAL(doneStatus, TW_MT_SLA_NACK);
+
+    /* Polling mode: isBusy() drives the transitions itself. */
+    reset();
+    TWI_CHECK_EQUAL(TWI0.setPolling(1), 1);
+    TWI_CHECK_EQUAL(TWI0.startTransmission(0x50, data, 4), 1);
+    TWI_CHECK(settle(1000) < 1000);
+    TWI_CHECK_EQUAL(TWI0.getStatus(), TW_MT_DATA_ACK);
+    TWI_CHECK_EQUAL(writtenCount, 4);
+    TWI_CHECK_EQUAL(TWI0.setPolling(0), 1);
+
+    return (TWI_TEST_RESULT());
+}
@@ -0,0 +1,71 @@
+/* Dependencies */
+#include "TWI_Test.h"
+#include "TWI_Dispatcher.h"
+
+/**
+ * @brief The dispatcher: the map of addresses to buses, and forwarding to the mapped bus.
+ *
+ * The host build has one simulated bus on both sides of the dispatcher, so the routes are
+ * checked through `route()` and the forwarded calls run against the simulated devices.
+ */
+
+static uint8_t written[16];    //< The bytes the devices received.
+static uint8_t writtenCount;   //< The number of bytes the devices received.
+
+static void deviceWrite(const uint8_t byte) { written[writtenCount++] = byte; }
+static uint8_t deviceRead(void) { return (0x42); }
+
+int main(void)
+{
+    TWI_SimDevice devices[2] =
+    {
+        {0x1E, 0, 0, 0, deviceRead, deviceWrite, 0, 0},
+        {0x1F, 0, 0, 0, deviceRead, deviceWrite, 0, 0},
+    };
+    TWI_DualBus sensors(TWI0, TWI0);
+    uint8_t expected[128] = {0};
+    const uint8_t data[2] = {1, 2};
+    uint8_t sample[3] = {0};
+
+    /* Every address starts on the first bus. */
+    uint8_t routed = 0;
+    for (uint8_t address = 0; address < 128; address++)
+        routed += sensors.route(address);
+    TWI_CHECK_EQUAL(routed, 0);
+
+    /* Each address has a bit of its own: the ends of every map byte and a few in between. */
+    const uint8_t second[8] = {0x00, 0x07, 0x08, 0x1F, 0x40, 0x55, 0x78, 0x7F};
+    for (uint8_t i = 0; i < 8; i++)
+    {
+        TWI_CHECK_EQUAL(sensors.assign(second[i], 1), 1);
+        expected[second[i]] = 1;
+    }
+    TWI_CHECK_EQUAL(sensors.assign(0x55, 0), 1);  /**< Moved back. */
+    expected[0x55] = 0;
+    for (uint8_t address = 0; address < 128; address++)
+        TWI_CHECK_EQUAL(sensors.route(address), expected[address]);
+
+    TWI_CHECK_EQUAL(sensors.assign(0x80, 1), 0);  /**< Not a 7-bit address. */
+    TWI_CHECK_EQUAL(sensors.assign(0x1E, 2), 0);  /**< No third bus. */
+    TWI_CHECK_EQUAL(sensors.route(0x1E), 0);
+
+    /* Calls are forwarded to the bus of the device. */
+    TWI_Sim.attach(devices, 2);
+    TWI_CHECK_EQUAL(sensors.begin(), 0);  /**< The second side finds the one bus up already. */
+    TWI_CHECK_EQUAL(sensors.transmit(0x1F, data, 2), TW_MT_DATA_ACK);
+    TWI_CHECK_EQUAL(writtenCount, 2);
+    TWI_CHECK_EQUAL(sensors.requestFrom(0x1E, sample, 3), 3);
+    TWI_CHECK_EQUAL(sample[2], 0x42);
+    TWI_CHECK_EQUAL(sensors.writeThenRead(0x1F, data, 1, sample, 2), 2);
+    TWI_CHECK_EQUAL(written[2], 1);
+
+    TWI_Transaction left = {0x1E, data, 2};
+    TWI_Transaction right = {0x1F, NULL, 0, sample, 3};
+    TWI_CHECK_EQUAL(sensors.enqueue(&left), 1);
+    TWI_CHECK_EQUAL(sensors.enqueue(&right), 1);
+    TWI_CHECK_EQUAL(sensors.queued(), 2);  /**< Both sides count the one queue. */
+    TWI_CHECK_EQUAL(sensors.wait(&right, 5000), TW_MR_DATA_NACK);
+    TWI_CHECK_EQUAL(left.status, TW_MT_DATA_ACK);
+
+    return (TWI_TEST_RESULT());
+}
@@ -0,0 +1,79 @@
+/* Dependencies */
+#include "TWI_Test.h"
+
+/**
+ * @brief Fault injection of the simulator: held lines and slow STOP conditions.
+ */
+
+static uint8_t writtenCount;   //< The number of bytes the device received.
+
+static void deviceWrite(const uint8_t) { writtenCount++; }
+
+int main(void)
+{
+    TWI_SimDevice devices[1] = {{0x50, 0, 0, 0, NULL, deviceWrite, 0, 0}};
+    const uint8_t scl = (1 << TWI_HostRegisters::SCL), sda = (1 << TWI_HostRegisters::SDA);
+    const uint8_t data[2] = {1, 2};
+    TWI_SimStats stats;
+
+    TWI_Sim.attach(devices, 1);
+
+    /* The lines as GPIOs, the TWI still off: a held SDA lets go after the given SCL pulses. */
+    TWI_CHECK_EQUAL(TWI_HostRegisters::pin() & (scl | sda), scl | sda);
+    TWI_Sim.holdSda(2);
+    TWI_CHECK_EQUAL(TWI_HostRegisters::pin() & (scl | sda), scl);
+    for (uint8_t pulse = 0; pulse < 2; pulse++)
+    {
+        TWI_HostRegisters::ddr() |= scl;
+        TWI_CHECK_EQUAL(TWI_HostRegisters::pin() & scl, 0);  /**< Driven low, port is 0. */
+        TWI_HostRegisters::ddr() &= ~scl;
+    }
+    TWI_CHECK_EQUAL(TWI_HostRegisters::pin() & (scl | sda), scl | sda);
+    TWI_Sim.snapshot(&stats);
+    TWI_CHECK_EQUAL(stats.sclPulses, 2);
+
+    /* A slave holding SCL swallows the pulses. */
+    TWI_Sim.holdSda(1);
+    TWI_Sim.holdScl(1);
+    TWI_CHECK_EQUAL(TWI_HostRegisters::pin() & (scl | sda), 0);
+    TWI_HostRegisters::ddr() |= scl;
+    TWI_HostRegisters::ddr() &= ~scl;
+    TWI_CHECK_EQUAL(TWI_HostRegisters::pin() & sda, 0);
+    TWI_Sim.holdScl(0);
+    TWI_Sim.holdSda(0);
+
+    /* A held SCL stalls a transaction; it continues where it was once released. */
+    TWI0.begin();
+    TWI_Sim.resetStats();
+    TWI_Sim.holdScl(1);
+    TWI_CHECK_EQUAL(TWI0.startTransmission(0x50, data, 2), 1);
+    TWI_Sim.run(1000);
+    TWI_CHECK_EQUAL(TWI0.isBusy(), 1);
+    TWI_CHECK_EQUAL(writtenCount, 0);
+    TWI_Sim.snapshot(&stats);
+    TWI_CHECK_EQUAL(stats.busCycles, 0);  /**< Nothing was clocked. */
+    TWI_Sim.holdScl(0);
+    for (uint8_t i = 0; i < 100 && TWI0.isBusy(); i++)  /**< In polling mode isBusy() drives the bus. */
+        TWI_Sim.run(10);
+    TWI_CHECK_EQUAL(TWI0.isBusy(), 0);
+    TWI_CHECK_EQUAL(TWI0.getStatus(), TW_MT_DATA_ACK);
+    TWI_CHECK_EQUAL(writtenCount, 2);
+
+    /* A slow STOP keeps TWSTO set, a START follows it. */
+    TWI_Sim.resetStats();
+    TWI_Sim.setStopDelay(400);
+    const uint64_t start = TWI_Sim.now();
+    TWI_CHECK_EQUAL(TWI0.transmit(0x50, data, 2), TW_MT_DATA_ACK);
+    TWI_Sim.snapshot(&stats);
+    TWI_CHECK(TWI_Sim.now() - start >= stats.busCycles);
+    TWI_CHECK_EQUAL(TWI_Sim.control() & (1 << TWSTO), 0);
+    TWI_CHECK_EQUAL(TWI0.transmit(0x50, data, 2), TW_MT_DATA_ACK);
+    TWI_Sim.setStopDelay(0);
+
+    /* A held line hides the bus from an external master. */
+    TWI_Sim.holdSda(TWI_SIM_FOREVER);
+    TWI_CHECK_EQUAL(TWI_Sim.masterWrite(0x42, data, 2), 0);
+    TWI_Sim.holdSda(0);
+
+    return (TWI_TEST_RESULT());
+}
@@ -0,0 +1,107 @@
+/* Dependencies */
+#include "TWI_Test.h"
+
+/**
+ * @brief The instrumentation: byte and NACK counters, retries and the status trace.
+ */
+
+#ifdef TWI_INSTRUMENTATION  /**< Without it none of the counting code is compiled in. */
+/**
+ * @brief Returns the status code `back` entries before the newest one in the trace.
+ */
+static uint8_t traced(const TWI_Stats* stats, const uint8_t back)
+{
+    return (stats->trace[(stats->traceHead + TWI_TRACE_SIZE - 1 - back) % TWI_TRACE_SIZE].status);
+}
+
+#ifndef TWI_POLLING  /**< The external master of the simulator needs the ISR to answer it. */
+static void slave_rx(const TWI0_Bus::length_t) { }
+static void slave_tx(void) { TWI0.write((uint8_t)0x5A); TWI0.write((uint8_t)0xA5); }
+#endif
+#endif
+
+int main(void)
+{
+#ifdef TWI_INSTRUMENTATION
+    TWI_SimDevice devices[3] =
+    {
+        {0x20, 0, 2, 0, NULL, NULL, 0, 0},  /**< A FIFO taking two bytes per transaction. */
+        {0x50, 0, 0, 0, NULL, NULL, 0, 0},
+        {0x51, 1, 0, 0, NULL, NULL, 0, 0},  /**< A device refusing its address. */
+    };
+    const uint8_t data[3] = {1, 2, 3};
+    uint8_t sample[4] = {0};
+    TWI_Stats stats;
+
+    TWI_Sim.attach(devices, 3);
+    TWI0.begin();
+    TWI0.resetStats();
+    TWI0.snapshot(&stats);
+    TWI_CHECK_EQUAL(stats.txBytes, 0);
+    TWI_CHECK_EQUAL(stats.traceHead, 0);
+
+    /* Every data byte is counted in its direction, the trace holds the statuses in order. */
+    TWI_CHECK_EQUAL(TWI0.transmit(0x50, data, 2), TW_MT_DATA_ACK);
+    TWI0.snapshot(&stats);
+    TWI_CHECK_EQUAL(stats.txBytes, 2);
+    TWI_CHECK_EQUAL(stats.rxBytes, 0);
+    TWI_CHECK_EQUAL(stats.traceHead, 4);
+    TWI_CHECK_EQUAL(traced(&stats, 3), TW_START);
+    TWI_CHECK_EQUAL(traced(&stats, 2), TW_MT_SLA_ACK);
+    TWI_CHECK_EQUAL(traced(&stats, 1), TW_MT_DATA_ACK);
+    TWI_CHECK_EQUAL(traced(&stats, 0), TW_MT_DATA_ACK);
+
+    TWI_CHECK_EQUAL(TWI0.requestFrom(0x50, sample, 3), 3);
+    TWI0.snapshot(&stats);
+    TWI_CHECK_EQUAL(stats.rxBytes, 3);
+    TWI_CHECK_EQUAL(traced(&stats, 0), TW_MR_DATA_NACK);  /**< The last byte is NACKed by the master. */
+    TWI_CHECK_EQUAL(stats.slaNacks, 0);
+    TWI_CHECK_EQUAL(stats.dataNacks, 0);
+
+    /* A refused byte is sent all the same: it counts as a data NACK and a sent byte. */
+    TWI_CHECK_EQUAL(TWI0.transmit(0x20, data, 3), TW_MT_DATA_NACK);
+    TWI0.snapshot(&stats);
+    TWI_CHECK_EQUAL(stats.dataNacks, 1);
+    TWI_CHECK_EQUAL(stats.txBytes, 2 + 3);
+
+    /* Every refused address counts, a repeated transaction counts as a retry. */
+    TWI_Transaction busy = {0x51, data, 1};
+    busy.retries = 2;
+    TWI_CHECK_EQUAL(TWI0.enqueue(&busy), 1);
+    TWI_CHECK_EQUAL(TWI0.wait(&busy, 5000), TW_MT_SLA_NACK);
+    TWI0.snapshot(&stats);
+    TWI_CHECK_EQUAL(stats.slaNacks, 3);
+    TWI_CHECK_EQUAL(stats.retries, 2);
+    TWI_CHECK_EQUAL(stats.arbitrationLost, 0);
+    TWI_CHECK_EQUAL(stats.busErrors, 0);
+    TWI_CHECK(stats.waitSpins > 0);
+
+    /* The trace keeps the newest TWI_TRACE_SIZE statuses, oldest at the head. */
+    TWI_CHECK_EQUAL(traced(&stats, 0), TW_MT_SLA_NACK);
+    TWI_CHECK_EQUAL(traced(&stats, 1), TW_START);  /**< Each retry starts over. */
+
+#ifndef TWI_POLLING
+    /* As slave, the bytes of the external master are counted the other way around. */
+    TWI0.end();
+    TWI0.resetStats();
+    TWI0.begin((uint8_t)0x42);
+    TWI0.setRxCallback(slave_rx);
+    TWI0.setTxCallback(slave_tx);
+    TWI_CHECK_EQUAL(TWI_Sim.masterWrite(0x42, data, 3), 3);
+    TWI_CHECK_EQUAL(TWI_Sim.masterRead(0x42, sample, 2), 2);
+    TWI0.snapshot(&stats);
+    TWI_CHECK_EQUAL(stats.rxBytes, 3);
+    TWI_CHECK_EQUAL(stats.txBytes, 2);
+#endif
+
+    /* resetStats() zeroes every counter and the trace. */
+    TWI0.resetStats();
+    TWI0.snapshot(&stats);
+    TWI_CHECK_EQUAL(stats.txBytes + stats.rxBytes, 0);
+    TWI_CHECK_EQUAL(stats.slaNacks + stats.dataNacks + stats.retries, 0);
+    TWI_CHECK_EQUAL(stats.traceHead, 0);
+    TWI_CHECK_EQUAL(stats.trace[0].status, 0);
+#endif
+
+    return (TWI_TEST_RESULT());
+}
@@ -0,0 +1,45 @@
+/* Dependencies */
+#include "TWI_Test.h"
+#include "TWI_Memory.h"
+
+/**
+ * @brief The EEPROM layer: page splitting, ACK polling and the bus timeout.
+ */
+
+static uint16_t writtenCount;  //< The bytes the device received, memory addresses included.
+
+static void memoryWrite(const uint8_t) { writtenCount++; }
+static uint8_t memoryRead(void) { return (0x5A); }
+
+int main(void)
+{
+    TWI_SimDevice devices[1] = {{0x50, 0, 0, 0, memoryRead, memoryWrite, 5000 * (F_CPU / 1000000UL), 0}};
+    TWI_Memory<TWI0_Bus> eeprom(TWI0, 0x50, 16, 2);
+    uint8_t data[40] = {0}, copy[40] = {0};
+    TWI_SimStats stats;
+
+    TWI_Sim.attach(devices, 1);
+    TWI0.begin();
+
+    /* Three pages, each one waiting out the write cycle of the previous one on the bus. */
+    TWI_Sim.resetStats();
+    TWI_CHECK_EQUAL(eeprom.write(0x0008, data, sizeof(data)), sizeof(data));
+    TWI_Sim.snapshot(&stats);
+    TWI_CHECK(stats.transactions > 3);  /**< Refused addresses were polled again. */
+    TWI_CHECK_EQUAL(writtenCount, sizeof(data) + 3 * 2);  /**< 8 + 16 + 16 bytes, each page with its address. */
+    TWI_CHECK_EQUAL(eeprom.read(0x0008, copy, sizeof(copy)), sizeof(copy));
+    TWI_CHECK_EQUAL(copy[39], 0x5A);
+
+    /* A hung bus gives up after the bus timeout, not the default one. */
+    TWI0.setTimeout(500);
+    TWI_Sim.holdScl(1);
+    const uint64_t start = TWI_Sim.now();
+    TWI_CHECK_EQUAL(eeprom.read(0x0000, copy, 4), 0);
+    TWI_CHECK(TWI_Sim.now() - start < 2000 * (F_CPU / 1000000UL));
+    TWI_CHECK_EQUAL(eeprom.getStatus(), TWI_ERROR_BUS_STUCK);
+    TWI_Sim.holdScl(0);
+    TWI_CHECK_EQUAL(TWI0.recover(), 1);
+    TWI_CHECK_EQUAL(eeprom.read(0x0008, copy, 2), 2);  /**< The descriptor is free again. */
+
+    return (TWI_TEST_RESULT());
+}
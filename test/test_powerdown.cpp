@@ -0,0 +1,58 @@
+/* Dependencies */
+#include "TWI_Test.h"
+
+/**
+ * @brief Power-down of an idle slave: woken by its address, or by another interrupt.
+ */
+
+static uint8_t received;  //< The size the RX callback got.
+
+static void slave_rx(const TWI0_Bus::length_t size) { received = size; }
+
+#ifndef TWI_POLLING  /**< The external master of the simulator needs the ISR to answer it. */
+/**
+ * @brief The external master writing to the slave while the CPU sleeps.
+ */
+static void addressed(void)
+{
+    const uint8_t data[2] = {0x12, 0x34};
+    TWI_Sim.masterWrite(0x42, data, 2);
+}
+#endif
+
+int main(void)
+{
+    TWI_SimStats stats;
+
+    /* A master is not woken by an address, it does not sleep at all. */
+    TWI0.begin();
+    TWI_Sim.resetStats();
+    TWI_CHECK_EQUAL(TWI0.powerDown(), 0);
+    TWI_Sim.snapshot(&stats);
+    TWI_CHECK_EQUAL(stats.sleepCycles, 0);
+    TWI0.end();
+
+    TWI0.begin((uint8_t)0x42);
+    TWI0.setRxCallback(slave_rx);
+    TWI_Sim.resetStats();
+#ifndef TWI_POLLING
+    /* Without its address, the next periodic interrupt wakes the MCU. */
+    TWI_CHECK_EQUAL(TWI0.powerDown(), 0);
+    TWI_Sim.snapshot(&stats);
+    TWI_CHECK_EQUAL(stats.sleepCycles, (uint64_t)TWI_SLEEP_TICK * (F_CPU / 1000000UL));
+    TWI_CHECK_EQUAL(stats.interrupts, 0);
+
+    /* Addressed while asleep, the slave wakes up and has the message. */
+    TWI_Sim.setWakeup(addressed);
+    TWI_CHECK_EQUAL(TWI0.powerDown(), 1);
+    TWI_CHECK_EQUAL(received, 2);
+    TWI_CHECK_EQUAL(TWI0.read(), 0x12);
+#else
+    /* Polling mode has no interrupt to wake the MCU, it does not sleep at all. */
+    TWI_CHECK_EQUAL(TWI0.powerDown(), 0);
+    TWI_Sim.snapshot(&stats);
+    TWI_CHECK_EQUAL(stats.sleepCycles, 0);
+#endif
+
+    return (TWI_TEST_RESULT());
+}
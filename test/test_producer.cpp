@@ -0,0 +1,57 @@
+/* Dependencies */
+#include "TWI_Test.h"
+
+/**
+ * @brief The slave TX producer: one call per byte read, for replies of any length.
+ */
+
+#ifndef TWI_POLLING  /**< The external master of the simulator needs the ISR to answer it. */
+static uint8_t produced;        //< The number of bytes the producer returned.
+static uint8_t producedAddress; //< The matched address the producer saw.
+static uint8_t callbackCount;   //< The number of times the TX callback ran.
+
+static uint8_t slave_producer(void) { producedAddress = TWI0.getMatchedAddress(); return (++produced); }
+static void slave_tx(void) { callbackCount++; TWI0.write((uint8_t)0xC3); }
+#endif
+
+int main(void)
+{
+#ifndef TWI_POLLING
+    static volatile uint8_t registers[2] = {0x11, 0x22};
+    uint8_t reply[TWI_BUFFER_SIZE + 8] = {0};
+
+    TWI0.begin((uint8_t)0x40, (uint8_t)0x01);
+    TWI0.setTxCallback(slave_tx);
+    TWI0.setTxProducer(slave_producer);
+
+    /* Every byte is pulled from the producer, longer replies than the buffer included. */
+    TWI_CHECK_EQUAL(TWI_Sim.masterRead(0x41, reply, sizeof(reply)), sizeof(reply));
+    TWI_CHECK_EQUAL(produced, sizeof(reply));
+    for (uint8_t i = 0; i < sizeof(reply); i++)
+        TWI_CHECK_EQUAL(reply[i], i + 1);
+    TWI_CHECK_EQUAL(producedAddress, 0x41);
+    TWI_CHECK_EQUAL(callbackCount, 0);
+
+    /* The master ends the read whenever it has enough, the next one goes on from there. */
+    TWI_CHECK_EQUAL(TWI_Sim.masterRead(0x40, reply, 2), 2);
+    TWI_CHECK_EQUAL(reply[1], sizeof(reply) + 2);
+    TWI_CHECK_EQUAL(producedAddress, 0x40);
+
+    /* A register map takes precedence over the producer. */
+    const uint8_t pointer = 1;
+    TWI_CHECK_EQUAL(TWI0.setRegisterMap(registers, 2), 1);
+    TWI_CHECK_EQUAL(TWI_Sim.masterWriteRead(0x40, &pointer, 1, reply, 1), 1);
+    TWI_CHECK_EQUAL(reply[0], 0x22);
+    TWI_CHECK_EQUAL(produced, sizeof(reply) + 2);
+    TWI_CHECK_EQUAL(TWI0.setRegisterMap(NULL, 0), 1);
+
+    /* Without the producer the TX callback and the buffer are back. */
+    TWI0.setTxProducer(NULL);
+    TWI_CHECK_EQUAL(TWI_Sim.masterRead(0x40, reply, 1), 1);
+    TWI_CHECK_EQUAL(reply[0], 0xC3);
+    TWI_CHECK_EQUAL(callbackCount, 1);
+    TWI_CHECK_EQUAL(produced, sizeof(reply) + 2);
+#endif
+
+    return (TWI_TEST_RESULT());
+}
@@ -0,0 +1,105 @@
+/* Dependencies */
+#include "TWI_Test.h"
+
+/**
+ * @brief The transaction queue: chaining, and launching on a bus held by a repeated START.
+ */
+
+static uint8_t written[64];    //< The bytes the devices received.
+static uint8_t writtenCount;   //< The number of bytes the devices received.
+
+static void deviceWrite(const uint8_t byte) { written[writtenCount++] = byte; }
+static uint8_t deviceRead(void) { return (0x42); }
+
+int main(void)
+{
+    TWI_SimDevice devices[2] =
+    {
+        {0x50, 0, 0, 0, deviceRead, deviceWrite, 0, 0},
+        {0x1E, 0, 0, 0, deviceRead, deviceWrite, 0, 0},
+    };
+    const uint8_t data[4] = {1, 2, 3, 4};
+    uint8_t sample[3] = {0};
+    TWI_SimStats stats;
+
+    TWI_Sim.attach(devices, 2);
+    TWI0.begin();
+
+    /* Back-to-back: the ISR chains every queued transaction, in order. */
+    TWI_Transaction first = {0x50, data, 2};
+    TWI_Transaction second = {0x1E, data + 2, 2};
+    TWI_Transaction third = {0x1E, NULL, 0, sample, 3};
+    TWI_CHECK_EQUAL(TWI0.enqueue(&first), 1);
+    TWI_CHECK_EQUAL(TWI0.enqueue(&second), 1);
+    TWI_CHECK_EQUAL(TWI0.enqueue(&third), 1);
+    TWI_CHECK_EQUAL(TWI0.queued(), 2);  /**< The first one is on the bus already. */
+    TWI_CHECK_EQUAL(TWI0.wait(&third, 5000), TW_MR_DATA_NACK);
+    TWI_CHECK(first.done && second.done);
+    TWI_CHECK_EQUAL(first.status, TW_MT_DATA_ACK);
+    TWI_CHECK_EQUAL(second.status, TW_MT_DATA_ACK);
+    TWI_CHECK_EQUAL(writtenCount, 4);
+    TWI_CHECK_EQUAL(written[3], 4);
+    TWI_CHECK_EQUAL(third.count, 3);
+    TWI_CHECK_EQUAL(sample[2], 0x42);
+
+    /* A full queue refuses more. */
+    TWI_Transaction spare[TWI_QUEUE_SIZE + 1];
+    for (uint8_t i = 0; i <= TWI_QUEUE_SIZE; i++)
+        spare[i] = TWI_Transaction{0x50, data, 1};
+    for (uint8_t i = 0; i <= TWI_QUEUE_SIZE; i++)  /**< One on the bus, the rest queued. */
+        TWI_CHECK_EQUAL(TWI0.enqueue(&spare[i]), 1);
+    TWI_Transaction refused = {0x50, data, 1};
+    TWI_CHECK_EQUAL(TWI0.enqueue(&refused), 0);
+    TWI_CHECK_EQUAL(TWI0.wait(&spare[TWI_QUEUE_SIZE], 5000), TW_MT_DATA_ACK);
+
+    /* Regression: a transaction enqueued after one ending with a repeated START is launched. */
+    writtenCount = 0;
+    TWI_CHECK_EQUAL(TWI0.transmit(0x50, data, 2, 0), TW_MT_DATA_ACK);  /**< Keep the bus. */
+    TWI_Transaction after = {0x50, data, 2};
+    TWI_Sim.resetStats();
+    TWI_CHECK_EQUAL(TWI0.enqueue(&after), 1);
+    TWI_CHECK_EQUAL(TWI0.wait(&after, 5000), TW_MT_DATA_ACK);
+    TWI_CHECK_EQUAL(after.done, 1);
+    TWI_CHECK_EQUAL(writtenCount, 4);
+    TWI_Sim.snapshot(&stats);
+    TWI_CHECK_EQUAL(stats.transactions, 0);  /**< It took the repeated START, no new START. */
+
+    /* The same right after the repeated START was issued, while it is still on the wire. */
+    TWI_CHECK_EQUAL(TWI0.startTransmission(0x50, data, 2, 0), 1);
+    while (TWI0.isBusy())
+        TWI_Sim.run(1);
+    TWI_CHECK_EQUAL(TWI0.enqueue(&after), 1);
+    TWI_CHECK_EQUAL(TWI0.wait(&after, 5000), TW_MT_DATA_ACK);
+
+    /* A transaction queued behind one ending with a repeated START is chained by the ISR. */
+    TWI_CHECK_EQUAL(TWI0.startTransmission(0x50, data, 2, 0), 1);
+    TWI_CHECK_EQUAL(TWI0.enqueue(&after), 1);
+    TWI_CHECK_EQUAL(TWI0.wait(&after, 5000), TW_MT_DATA_ACK);
+    TWI_CHECK_EQUAL(TWI0.getStatus(), TW_MT_DATA_ACK);
+
+#ifndef TWI_LEAN  /**< The lean build has no scan. */
+    /* A scan pass started on a held bus runs as well. */
+    const TWI_ScanEntry entries[1] = {{0x1E, 0x00, 2, 0}};
+    uint8_t front[2] = {0}, back[2] = {0};
+    uint8_t failed = 0xFF;
+    TWI_CHECK_EQUAL(TWI0.setScan(entries, 1, front, back), 1);
+    TWI_CHECK_EQUAL(TWI0.transmit(0x50, data, 1, 0), TW_MT_DATA_ACK);
+    TWI_CHECK_EQUAL(TWI0.scan(), 1);
+    for (uint16_t i = 0; i < 500; i++)  /**< In polling mode nothing moves without poll(). */
+    {
+        TWI0.poll();
+        TWI_Sim.run(1);
+    }
+    const uint8_t* snapshot = TWI0.takeScan(&failed);
+    TWI_CHECK(snapshot != NULL);
+    TWI_CHECK_EQUAL(failed, 0);
+    if (snapshot != NULL)
+        TWI_CHECK_EQUAL(snapshot[1], 0x42);
+#endif
+
+    /* The blocking API continues on a held bus too. */
+    TWI_CHECK_EQUAL(TWI0.transmit(0x50, data, 1, 0), TW_MT_DATA_ACK);
+    TWI_CHECK_EQUAL(TWI0.requestFrom(0x1E, sample, 2), 2);
+
+    return (TWI_TEST_RESULT());
+}
@@ -0,0 +1,86 @@
+/* Dependencies */
+#include "TWI_Test.h"
+
+/**
+ * @brief Timeouts and bus recovery against a stuck bus.
+ */
+
+static uint8_t writtenCount;   //< The number of bytes the device received.
+
+static void deviceWrite(const uint8_t) { writtenCount++; }
+
+int main(void)
+{
+    TWI_SimDevice devices[1] = {{0x50, 0, 0, 0, NULL, deviceWrite, 0, 0}};
+    const uint8_t data[2] = {1, 2};
+    TWI_SimStats stats;
+
+    TWI_Sim.attach(devices, 1);
+    TWI0.begin();
+    TWI0.setTimeout(2000);
+
+    /* A slave holding SDA lets go after five pulses: the call times out, the bus is recovered. */
+    TWI_Sim.resetStats();
+    TWI_Sim.holdSda(5);
+    TWI_CHECK_EQUAL(TWI0.transmit(0x50, data, 2), TWI_ERROR_TIMEOUT);
+    TWI_Sim.snapshot(&stats);
+    TWI_CHECK_EQUAL(stats.sclPulses, 5);
+    TWI_CHECK(stats.maxMasked < 100);  /**< The pulses are clocked with interrupts enabled. */
+    TWI_CHECK_EQUAL(stats.drivenHigh, 0);     /**< Open-drain: a line is driven low or released... */
+    TWI_CHECK_EQUAL(stats.floatingReads, 0);  /**< ...and pulled up whenever it is read. */
+    TWI_CHECK_EQUAL(TWI0.transmit(0x50, data, 2), TW_MT_DATA_ACK);
+
+    /* A slave that never lets go: the bus stays stuck until it does. */
+    TWI_Sim.holdSda(TWI_SIM_FOREVER);
+    TWI_CHECK_EQUAL(TWI0.transmit(0x50, data, 2), TWI_ERROR_BUS_STUCK);
+    TWI_CHECK_EQUAL(TWI0.recover(), 0);
+    TWI_Sim.holdSda(0);
+    TWI_CHECK_EQUAL(TWI0.recover(), 1);
+    TWI_CHECK_EQUAL(TWI0.transmit(0x50, data, 2), TW_MT_DATA_ACK);
+
+    /* A held SCL can't be recovered either. */
+    TWI_Sim.holdScl(1);
+    TWI_CHECK_EQUAL(TWI0.transmit(0x50, data, 2), TWI_ERROR_BUS_STUCK);
+    TWI_Sim.holdScl(0);
+    TWI_CHECK_EQUAL(TWI0.recover(), 1);
+
+    /* A STOP slower than TWI_STOP_TIMEOUT makes the bus stuck, a slow one within it doesn't. */
+    TWI_Sim.setStopDelay(TWI_STOP_TIMEOUT * (F_CPU / 1000000UL) * 2);
+    TWI_CHECK_EQUAL(TWI0.transmit(0x50, data, 2), TWI_ERROR_BUS_STUCK);
+    TWI_Sim.setStopDelay(TWI_STOP_TIMEOUT * (F_CPU / 1000000UL) / 2);
+    TWI_CHECK_EQUAL(TWI0.transmit(0x50, data, 2), TW_MT_DATA_ACK);
+    TWI_CHECK_EQUAL(TWI0.transmit(0x50, data, 2), TW_MT_DATA_ACK);  /**< The START followed the STOP. */
+    TWI_Sim.setStopDelay(0);
+
+    /* A queued transaction timing out leaves the queue, so it can be reused at once. */
+    TWI_Transaction first = {0x50, data, 2};
+    TWI_Transaction second = {0x50, data, 2};
+    TWI_Sim.holdScl(1);
+    TWI_CHECK_EQUAL(TWI0.enqueue(&first), 1);
+    TWI_CHECK_EQUAL(TWI0.enqueue(&second), 1);
+    TWI_CHECK_EQUAL(TWI0.queued(), 1);
+    uint64_t start = TWI_Sim.now();
+    TWI_CHECK_EQUAL(TWI0.wait(&second, 500), TWI_ERROR_TIMEOUT);
+    TWI_CHECK(TWI_Sim.now() - start < 2000 * (F_CPU / 1000000UL));  /**< Its own timeout, not the instance one. */
+    TWI_CHECK_EQUAL(second.done, 1);
+    TWI_CHECK_EQUAL(TWI0.queued(), 0);
+    TWI_CHECK_EQUAL(first.done, 1);
+    TWI_CHECK_EQUAL(first.status, TWI_ERROR_BUS_STUCK);  /**< Aborted on the bus, SCL is still held. */
+    TWI_Sim.holdScl(0);
+    TWI_CHECK_EQUAL(TWI0.recover(), 1);
+    second.status = 0xAA;  /**< Nothing may touch it anymore. */
+    writtenCount = 0;
+    TWI_CHECK_EQUAL(TWI0.transmit(0x50, data, 2), TW_MT_DATA_ACK);
+    TWI_CHECK_EQUAL(second.status, 0xAA);
+    TWI_CHECK_EQUAL(writtenCount, 2);
+
+    /* The instance timeout is still in effect after a wait() with its own. */
+    TWI_Sim.holdScl(1);
+    start = TWI_Sim.now();
+    TWI_CHECK_EQUAL(TWI0.transmit(0x50, data, 2), TWI_ERROR_BUS_STUCK);
+    TWI_CHECK(TWI_Sim.now() - start >= 2000 * (F_CPU / 1000000UL));
+    TWI_Sim.holdScl(0);
+    TWI_CHECK_EQUAL(TWI0.recover(), 1);
+
+    return (TWI_TEST_RESULT());
+}
@@ -0,0 +1,76 @@
+/* Dependencies */
+#include "TWI_Test.h"
+
+/**
+ * @brief The slave register map: pointer, auto-increment, wrap-around and access masks.
+ */
+
+#ifndef TWI_POLLING  /**< The external master of the simulator needs the ISR to answer it. */
+static uint8_t callbackCount;  //< The number of times a slave callback ran.
+
+static void slave_rx(const TWI0_Bus::length_t) { callbackCount++; }
+static void slave_tx(void) { callbackCount++; }
+#endif
+
+int main(void)
+{
+#ifndef TWI_POLLING
+    static volatile uint8_t registers[8] = {0xA5, 0x01, 0, 0, 0x44, 0x55, 0x66, 0x77};
+    static const uint8_t readOnly[1] = {0x03};   /**< Registers 0 and 1 hold the device ID. */
+    static const uint8_t writeOnly[1] = {0x80};  /**< Register 7 is a command. */
+    uint8_t reply[4] = {0};
+
+    TWI0.begin((uint8_t)0x42);
+    TWI0.setRxCallback(slave_rx);
+    TWI0.setTxCallback(slave_tx);
+    TWI_CHECK_EQUAL(TWI0.setRegisterMap(registers, 0), 0);
+    TWI_CHECK_EQUAL(TWI0.setRegisterMap(registers, 257), 0);  /**< The pointer is a single byte. */
+    TWI_CHECK_EQUAL(TWI0.setRegisterMap(registers, 8, readOnly, writeOnly), 1);
+
+    /* The first byte of a write sets the pointer, the next ones are stored from there on. */
+    const uint8_t write[3] = {2, 0xAA, 0xBB};
+    TWI_CHECK_EQUAL(TWI_Sim.masterWrite(0x42, write, 3), 3);
+    TWI_CHECK_EQUAL(registers[2], 0xAA);
+    TWI_CHECK_EQUAL(registers[3], 0xBB);
+
+    /* A read after a repeated START starts at the pointer just written. */
+    const uint8_t pointer = 2;
+    TWI_CHECK_EQUAL(TWI_Sim.masterWriteRead(0x42, &pointer, 1, reply, 3), 3);
+    TWI_CHECK_EQUAL(reply[0], 0xAA);
+    TWI_CHECK_EQUAL(reply[1], 0xBB);
+    TWI_CHECK_EQUAL(reply[2], 0x44);
+
+    /* A plain read goes on where the last one stopped. */
+    TWI_CHECK_EQUAL(TWI_Sim.masterRead(0x42, reply, 1), 1);
+    TWI_CHECK_EQUAL(reply[0], 0x55);
+
+    /* Write-only registers read as 0xFF, the pointer wraps around the end of the map. */
+    const uint8_t last = 6;
+    TWI_CHECK_EQUAL(TWI_Sim.masterWriteRead(0x42, &last, 1, reply, 4), 4);
+    TWI_CHECK_EQUAL(reply[0], 0x66);
+    TWI_CHECK_EQUAL(reply[1], 0xFF);
+    TWI_CHECK_EQUAL(reply[2], 0xA5);
+    TWI_CHECK_EQUAL(reply[3], 0x01);
+
+    /* Read-only registers keep their value, the write goes on behind them. */
+    const uint8_t wrap[4] = {7, 0x33, 0x11, 0x22};
+    TWI_CHECK_EQUAL(TWI_Sim.masterWrite(0x42, wrap, 4), 4);
+    TWI_CHECK_EQUAL(registers[7], 0x33);
+    TWI_CHECK_EQUAL(registers[0], 0xA5);
+    TWI_CHECK_EQUAL(registers[1], 0x01);
+    const uint8_t beyond[2] = {0x09, 0x12};  /**< Out of range: starts over at register 0. */
+    TWI_CHECK_EQUAL(TWI_Sim.masterWrite(0x42, beyond, 2), 2);
+    TWI_CHECK_EQUAL(registers[0], 0xA5);
+    TWI_CHECK_EQUAL(TWI_Sim.masterRead(0x42, reply, 1), 1);
+    TWI_CHECK_EQUAL(reply[0], 0x01);  /**< The write moved the pointer on to register 1. */
+
+    TWI_CHECK_EQUAL(callbackCount, 0);  /**< The ISR served all of it alone. */
+
+    /* Without the map the callbacks are back. */
+    TWI_CHECK_EQUAL(TWI0.setRegisterMap(NULL, 0), 1);
+    TWI_CHECK_EQUAL(TWI_Sim.masterWrite(0x42, write, 1), 1);
+    TWI_CHECK_EQUAL(callbackCount, 1);
+#endif
+
+    return (TWI_TEST_RESULT());
+}
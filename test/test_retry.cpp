@@ -0,0 +1,93 @@
+/* Dependencies */
+#include "TWI_Test.h"
+
+/**
+ * @brief Retries of refused transactions: resume, backoff counted by tick() and exhaustion.
+ */
+
+static uint8_t written[32];    //< The bytes the devices received.
+static uint8_t writtenCount;   //< The number of bytes the devices received.
+
+static void deviceWrite(const uint8_t byte) { written[writtenCount++] = byte; }
+
+int main(void)
+{
+    TWI_SimDevice devices[2] =
+    {
+        {0x20, 0, 3, 0, NULL, deviceWrite, 0, 0},                           /**< A FIFO taking three bytes per transaction. */
+        {0x50, 0, 0, 0, NULL, NULL, 1000 * (F_CPU / 1000000UL), 0},         /**< An EEPROM in a 1 ms write cycle. */
+    };
+    const uint8_t data[8] = {1, 2, 3, 4, 5, 6, 7, 8};
+    TWI_SimStats stats;
+
+    TWI_Sim.attach(devices, 2);
+    TWI0.begin();
+
+    /* Resumed at every refused byte, each byte is received exactly once. */
+    TWI_Transaction fifo = {0x20, data, 8};
+    fifo.retries = 5;
+    fifo.resume = 1;
+    TWI_CHECK_EQUAL(TWI0.enqueue(&fifo), 1);
+    TWI_CHECK_EQUAL(TWI0.wait(&fifo, 5000), TW_MT_DATA_ACK);
+    TWI_CHECK_EQUAL(writtenCount, 8);
+    for (uint8_t i = 0; i < 8; i++)
+        TWI_CHECK_EQUAL(written[i], data[i]);
+
+    /* Started over, every attempt is refused at the same byte until the retries run out. */
+    writtenCount = 0;
+    fifo.resume = 0;
+    fifo.retries = 2;
+    TWI_CHECK_EQUAL(TWI0.enqueue(&fifo), 1);
+    TWI_CHECK_EQUAL(TWI0.wait(&fifo, 5000), TW_MT_DATA_NACK);
+    TWI_CHECK_EQUAL(TWI0_Bus::result(fifo.status), TWI_RESULT_DATA_NACK);
+    TWI_CHECK_EQUAL(writtenCount, 3 * 3);  /**< The first attempt and two retries. */
+    TWI_CHECK_EQUAL(written[3], data[0]);
+
+    /* An SMBus write starts over even with resume, its PEC covers the whole transaction. */
+    writtenCount = 0;
+    fifo.resume = 1;
+    fifo.smbus = TWI_SMBUS_PEC;
+    TWI_CHECK_EQUAL(TWI0.enqueue(&fifo), 1);
+    TWI_CHECK_EQUAL(TWI0.wait(&fifo, 5000), TW_MT_DATA_NACK);
+    TWI_CHECK_EQUAL(writtenCount, 3 * 3);
+    TWI_CHECK_EQUAL(written[6], data[0]);
+
+    /* A busy device is retried after the backoff, and only once tick() has counted it down. */
+    TWI_Transaction eeprom = {0x50, data, 2};
+    TWI_CHECK_EQUAL(TWI0.transmit(0x50, data, 2), TW_MT_DATA_ACK);  /**< Starts the write cycle. */
+    eeprom.retries = 10;
+    eeprom.backoff = 300;
+    TWI_Sim.resetStats();
+    TWI_CHECK_EQUAL(TWI0.enqueue(&eeprom), 1);
+    for (uint16_t i = 0; i < 2000; i++)  /**< 2 ms without tick(): refused once, then silent. */
+    {
+        TWI0.poll();  /**< In polling mode nothing moves without it. */
+        TWI_Sim.run(1);
+    }
+    TWI_Sim.snapshot(&stats);
+    TWI_CHECK_EQUAL(eeprom.done, 0);
+    TWI_CHECK_EQUAL(stats.transactions, 1);
+    for (uint16_t i = 0; i < 2000 && !eeprom.done; i++)  /**< Now count the backoff down. */
+    {
+        TWI0.tick(100);
+        for (uint8_t j = 0; j < 100; j++)
+        {
+            TWI0.poll();
+            TWI_Sim.run(1);
+        }
+    }
+    TWI_CHECK_EQUAL(eeprom.done, 1);
+    TWI_CHECK_EQUAL(eeprom.status, TW_MT_DATA_ACK);
+    TWI_Sim.snapshot(&stats);
+    TWI_CHECK_EQUAL(stats.transactions, 2);  /**< The write cycle ended while the bus was silent. */
+
+    /* An absent device exhausts the backoff retries and reports the refused address. */
+    TWI_Transaction absent = {0x33, data, 2};
+    absent.retries = 2;
+    absent.backoff = 100;
+    TWI_CHECK_EQUAL(TWI0.enqueue(&absent), 1);
+    TWI_CHECK_EQUAL(TWI0.wait(&absent, 5000), TW_MT_SLA_NACK);
+    TWI_CHECK_EQUAL(TWI0_Bus::result(absent.status), TWI_RESULT_ADDRESS_NACK);
+
+    return (TWI_TEST_RESULT());
+}
@@ -0,0 +1,85 @@
+/* Dependencies */
+#include "TWI_Test.h"
+
+/**
+ * @brief The slave receive ring: frames collected by the ISR and drained from the main loop.
+ */
+
+#if !defined(TWI_LEAN) && !defined(TWI_POLLING)  /**< The lean build has no ring, the external master needs the ISR. */
+static uint8_t callbackCount;   //< The number of times the RX callback ran.
+static uint8_t dispatched[8];   //< The first byte of every dispatched frame.
+static uint8_t dispatchedCount; //< The number of dispatched frames.
+
+static void slave_rx(const TWI0_Bus::length_t) { callbackCount++; }
+static void slave_frame(const uint8_t* data, const uint8_t) { dispatched[dispatchedCount++] = data[0]; }
+#endif
+
+int main(void)
+{
+#if !defined(TWI_LEAN) && !defined(TWI_POLLING)
+    TWI_Frame frames[3];
+    uint8_t data[TWI_FRAME_SIZE + 2];
+    for (uint8_t i = 0; i < sizeof(data); i++)
+        data[i] = i + 1;
+
+    TWI0.begin((uint8_t)0x42);
+    TWI0.setRxCallback(slave_rx);
+    TWI0.setFrameCallback(slave_frame);
+    TWI_CHECK_EQUAL(TWI0.setRxRing(frames, 1), 0);  /**< One frame could never hold a message. */
+    TWI_CHECK_EQUAL(TWI0.setRxRing(frames, 3), 1);
+    TWI_CHECK(TWI0.peekFrame() == NULL);
+
+    /* Writes land in frames of their own, the RX callback no longer runs. */
+    TWI_CHECK_EQUAL(TWI_Sim.masterWrite(0x42, data, 3), 3);
+    TWI_CHECK_EQUAL(TWI_Sim.masterWrite(0x42, data + 5, 2), 2);
+    TWI_CHECK_EQUAL(TWI0.frames(), 2);
+    TWI_CHECK_EQUAL(callbackCount, 0);
+
+    /* With count - 1 frames waiting the ring is full: the data is NACKed, no frame overwritten. */
+    TWI_CHECK_EQUAL(TWI_Sim.masterWrite(0x42, data + 9, 2), 0);
+    TWI_CHECK_EQUAL(TWI0.frames(), 2);
+
+    const TWI_Frame* frame = TWI0.peekFrame();
+    TWI_CHECK(frame != NULL);
+    if (frame != NULL)
+    {
+        TWI_CHECK_EQUAL(frame->address, 0x42);
+        TWI_CHECK_EQUAL(frame->length, 3);
+        TWI_CHECK_EQUAL(frame->data[2], 3);
+    }
+    TWI0.releaseFrame();
+    frame = TWI0.peekFrame();
+    TWI_CHECK(frame != NULL);
+    if (frame != NULL)
+    {
+        TWI_CHECK_EQUAL(frame->length, 2);
+        TWI_CHECK_EQUAL(frame->data[0], 6);
+    }
+
+    /* Released frames are refilled around the end of the ring, dispatch() drains in order. */
+    TWI_CHECK_EQUAL(TWI_Sim.masterWrite(0x42, data + 20, 1), 1);
+    TWI_CHECK_EQUAL(TWI0.dispatch(), 2);
+    TWI_CHECK_EQUAL(dispatchedCount, 2);
+    TWI_CHECK_EQUAL(dispatched[0], 6);
+    TWI_CHECK_EQUAL(dispatched[1], 21);
+    TWI_CHECK(TWI0.peekFrame() == NULL);
+    TWI0.releaseFrame();  /**< Releasing an empty ring changes nothing. */
+    TWI_CHECK_EQUAL(TWI0.frames(), 0);
+
+    /* A frame takes TWI_FRAME_SIZE bytes, the byte filling it is the last one ACKed. */
+    TWI_CHECK_EQUAL(TWI_Sim.masterWrite(0x42, data, sizeof(data)), TWI_FRAME_SIZE);
+    frame = TWI0.peekFrame();
+    TWI_CHECK(frame != NULL);
+    if (frame != NULL)
+        TWI_CHECK_EQUAL(frame->length, TWI_FRAME_SIZE);
+    TWI0.releaseFrame();
+
+    /* Without the ring the buffer and the RX callback are back. */
+    TWI_CHECK_EQUAL(TWI0.setRxRing(NULL, 0), 1);
+    TWI_CHECK_EQUAL(TWI_Sim.masterWrite(0x42, data, 2), 2);
+    TWI_CHECK_EQUAL(callbackCount, 1);
+    TWI_CHECK_EQUAL(TWI0.available(), 2);
+#endif
+
+    return (TWI_TEST_RESULT());
+}
@@ -0,0 +1,168 @@
+/* Dependencies */
+#include "TWI_Test.h"
+#include "TWI_SMBus.h"
+
+/**
+ * @brief SMBus commands and PEC, as master against a scripted device and as slave.
+ */
+
+static uint8_t written[16];    //< The bytes the device received.
+static uint8_t writtenCount;   //< The number of bytes the device received.
+static uint8_t script[8];      //< The bytes the device sends, PEC included.
+static uint8_t scriptIndex;    //< The index of the next byte the device sends.
+
+static void deviceWrite(const uint8_t byte) { written[writtenCount++] = byte; }
+static uint8_t deviceRead(void) { return (script[scriptIndex++]); }
+
+#ifndef TWI_POLLING
+static uint8_t slavePec;       //< The PEC check of the last frame received as slave.
+
+static void slave_rx(const TWI0_Bus::length_t) { slavePec = TWI0.checkPec(); }
+static void slave_tx(void) { TWI0.write((uint8_t)0x5A); }
+#endif
+
+/**
+ * @brief The SMBus PEC, bit by bit, independent of the ISR's.
+ */
+static uint8_t pec(const uint8_t* bytes, const uint8_t size)
+{
+    uint8_t crc = 0;
+    for (uint8_t i = 0; i < size; i++)
+    {
+        crc ^= bytes[i];
+        for (uint8_t bit = 0; bit < 8; bit++)
+            crc = (crc & 0x80) ? (crc << 1) ^ TWI_SMBUS_POLYNOMIAL : (crc << 1);
+    }
+    return (crc);
+}
+
+static void reset(void)
+{
+    writtenCount = 0;
+    scriptIndex = 0;
+}
+
+int main(void)
+{
+    TWI_SimDevice devices[1] = {{0x0B, 0, 0, 0, deviceRead, deviceWrite, 0, 0}};
+    TWI_SMBus<TWI0_Bus> plain(TWI0, 0);
+    TWI_SMBus<TWI0_Bus> checked(TWI0, 1);
+    uint8_t byte = 0, length;
+    uint16_t word = 0;
+    uint8_t block[4] = {0};
+    const uint8_t data[3] = {1, 2, 3};
+
+    /* The PEC is CRC-8 with polynomial 0x07, the reference here matches its check value. */
+    const uint8_t check[9] = {'1', '2', '3', '4', '5', '6', '7', '8', '9'};
+    TWI_CHECK_EQUAL(pec(check, 9), 0xF4);
+
+    TWI_Sim.attach(devices, 1);
+    TWI0.begin();
+
+    /* Without PEC. */
+    TWI_CHECK_EQUAL(plain.quickCommand(0x0B, 0), TW_MT_SLA_ACK);
+    TWI_CHECK_EQUAL(plain.quickCommand(0x0B, 1), TW_MR_DATA_NACK);
+    TWI_CHECK_EQUAL(TWI0_Bus::result(plain.quickCommand(0x33, 0)), TWI_RESULT_ADDRESS_NACK);
+
+    reset();
+    TWI_CHECK_EQUAL(plain.writeWord(0x0B, 0x11, 0x1234), TW_MT_DATA_ACK);
+    TWI_CHECK_EQUAL(writtenCount, 3);
+    TWI_CHECK_EQUAL(written[1], 0x34);  /**< Little-endian. */
+    TWI_CHECK_EQUAL(written[2], 0x12);
+
+    reset();
+    script[0] = 0x78;
+    script[1] = 0x56;
+    TWI_CHECK_EQUAL(plain.readWord(0x0B, 0x12, &word), TW_MR_DATA_NACK);
+    TWI_CHECK_EQUAL(word, 0x5678);
+    TWI_CHECK_EQUAL(written[0], 0x12);
+
+    /* With PEC, appended to writes... */
+    reset();
+    const uint8_t writeByte[3] = {0x16, 0x10, 0x55};
+    TWI_CHECK_EQUAL(checked.writeByte(0x0B, 0x10, 0x55), TW_MT_DATA_ACK);
+    TWI_CHECK_EQUAL(writtenCount, 3);
+    TWI_CHECK_EQUAL(written[2], pec(writeByte, 3));
+
+    reset();
+    TWI_CHECK_EQUAL(checked.blockWrite(0x0B, 0x20, data, 3), TW_MT_DATA_ACK);
+    const uint8_t blockWrite[6] = {0x16, 0x20, 3, 1, 2, 3};
+    TWI_CHECK_EQUAL(writtenCount, 6);
+    TWI_CHECK_EQUAL(written[1], 3);  /**< The block count. */
+    TWI_CHECK_EQUAL(written[5], pec(blockWrite, 6));
+
+    /* ...and checked on reads, from the first address byte on. */
+    reset();
+    const uint8_t readByte[4] = {0x16, 0x30, 0x17, 0x42};
+    script[0] = 0x42;
+    script[1] = pec(readByte, 4);
+    TWI_CHECK_EQUAL(checked.readByte(0x0B, 0x30, &byte), TW_MR_DATA_NACK);
+    TWI_CHECK_EQUAL(byte, 0x42);
+    reset();
+    script[1] ^= 0x01;  /**< Corrupted on the bus. */
+    TWI_CHECK_EQUAL(checked.readByte(0x0B, 0x30, &byte), TWI_ERROR_PEC);
+
+    reset();
+    const uint8_t blockRead[7] = {0x16, 0x31, 0x17, 3, 7, 8, 9};
+    for (uint8_t i = 0; i < 4; i++)
+        script[i] = blockRead[3 + i];
+    script[4] = pec(blockRead, 7);
+    length = sizeof(block);
+    TWI_CHECK_EQUAL(checked.blockRead(0x0B, 0x31, block, &length), TW_MR_DATA_NACK);
+    TWI_CHECK_EQUAL(length, 3);
+    TWI_CHECK_EQUAL(block[2], 9);
+
+    /* A block larger than the destination is cut off and reported, not taken for a PEC error. */
+    reset();
+    script[0] = 6;
+    length = 2;
+    TWI_CHECK_EQUAL(checked.blockRead(0x0B, 0x31, block, &length), TWI_ERROR_TRUNCATED);
+    TWI_CHECK_EQUAL(length, 2);
+    TWI_CHECK_EQUAL(block[1], 8);
+    TWI_CHECK_EQUAL(scriptIndex, 3);  /**< Count and two bytes, the rest was never clocked. */
+
+    reset();
+    const uint8_t processCall[9] = {0x16, 0x40, 2, 1, 2, 0x17, 2, 0xAB, 0xCD};
+    script[0] = 2;
+    script[1] = 0xAB;
+    script[2] = 0xCD;
+    script[3] = pec(processCall, 9);
+    length = sizeof(block);
+    TWI_CHECK_EQUAL(checked.blockProcessCall(0x0B, 0x40, data, 2, block, &length), TW_MR_DATA_NACK);
+    TWI_CHECK_EQUAL(length, 2);
+    TWI_CHECK_EQUAL(block[1], 0xCD);
+    TWI_CHECK_EQUAL(writtenCount, 4);  /**< Command, count and two bytes, no PEC before the repeated START. */
+
+#ifndef TWI_POLLING  /**< The external master of the simulator needs the ISR to answer it. */
+    /* As slave: received frames are checked, replies carry the PEC of their own message. */
+    TWI0.end();
+    TWI0.begin((uint8_t)0x42);
+    TWI0.setPec(1);
+    TWI0.setRxCallback(slave_rx);
+    TWI0.setTxCallback(slave_tx);
+    uint8_t frame[3] = {0x50, 0x01, 0};
+    const uint8_t sent[3] = {0x84, 0x50, 0x01};
+    frame[2] = pec(sent, 3);
+    TWI_CHECK_EQUAL(TWI_Sim.masterWrite(0x42, frame, 3), 3);
+    TWI_CHECK_EQUAL(slavePec, 1);
+    frame[2] ^= 0x01;
+    TWI_CHECK_EQUAL(TWI_Sim.masterWrite(0x42, frame, 3), 3);
+    TWI_CHECK_EQUAL(slavePec, 0);
+
+    uint8_t reply[2] = {0};
+    const uint8_t receiveByte[2] = {0x85, 0x5A};  /**< After a STOP: the address byte of the read on. */
+    TWI_CHECK_EQUAL(TWI_Sim.masterRead(0x42, reply, 2), 2);
+    TWI_CHECK_EQUAL(reply[0], 0x5A);
+    TWI_CHECK_EQUAL(reply[1], pec(receiveByte, 2));
+
+    const uint8_t command = 0x60;
+    const uint8_t readJoined[4] = {0x84, 0x60, 0x85, 0x5A};  /**< Joined by a repeated START: the command on. */
+    TWI_CHECK_EQUAL(TWI_Sim.masterWriteRead(0x42, &command, 1, reply, 2), 2);
+    TWI_CHECK_EQUAL(reply[1], pec(readJoined, 4));
+
+    TWI_CHECK_EQUAL(TWI_Sim.masterRead(0x42, reply, 2), 2);  /**< The next read starts over. */
+    TWI_CHECK_EQUAL(reply[1], pec(receiveByte, 2));
+#endif
+
+    return (TWI_TEST_RESULT());
+}
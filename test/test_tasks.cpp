@@ -0,0 +1,97 @@
+/* Dependencies */
+#include "TWI_Test.h"
+
+/**
+ * @brief Cooperative tasks: submitted in order, judged once finished, and run again.
+ */
+
+static uint8_t written[16];    //< The bytes the devices received.
+static uint8_t writtenCount;   //< The number of bytes the devices received.
+
+static void deviceWrite(const uint8_t byte) { written[writtenCount++] = byte; }
+static uint8_t deviceRead(void) { return (0x42); }
+
+/**
+ * @brief Polls every task until none of them is pending any more, at most `limit` rounds.
+ */
+static void runAll(TWI_Task* tasks, const uint8_t count, uint16_t limit)
+{
+    uint8_t pending = 1;
+    while (pending && limit--)
+    {
+        pending = 0;
+        for (uint8_t i = 0; i < count; i++)
+            if (TWI0.poll(&tasks[i]) == TWI_TASK_PENDING)
+                pending = 1;
+        _delay_us(10);  /**< The rest of the main loop, the bus moves on meanwhile. */
+    }
+}
+
+int main(void)
+{
+    TWI_SimDevice devices[3] =
+    {
+        {0x50, 0, 0, 0, deviceRead, deviceWrite, 0, 0},
+        {0x1E, 0, 0, 0, deviceRead, deviceWrite, 0, 0},
+        {0x20, 0, 1, 0, NULL, deviceWrite, 0, 0},  /**< A FIFO taking one byte per transaction. */
+    };
+    const uint8_t data[4] = {1, 2, 3, 4};
+    uint8_t sample[3] = {0};
+
+    TWI_Sim.attach(devices, 3);
+    TWI0.begin();
+
+    /* A write, a read, a refused address and a refused byte, all in flight at once. */
+    TWI_Task tasks[4] =
+    {
+        {{0x50, data, 2}},
+        {{0x1E, NULL, 0, sample, 3}},
+        {{0x33, data, 1}},     /**< Nobody there. */
+        {{0x20, data + 2, 2}}, /**< The second byte is refused. */
+    };
+    TWI_CHECK_EQUAL(TWI0.poll(&tasks[0]), TWI_TASK_PENDING);  /**< Submitted, but not finished yet. */
+    runAll(tasks, 4, 1000);
+    TWI_CHECK_EQUAL(tasks[0].state, TWI_TASK_DONE);
+    TWI_CHECK_EQUAL(tasks[1].state, TWI_TASK_DONE);
+    TWI_CHECK_EQUAL(tasks[1].transaction.count, 3);
+    TWI_CHECK_EQUAL(sample[2], 0x42);
+    TWI_CHECK_EQUAL(tasks[2].state, TWI_TASK_ERROR);
+    TWI_CHECK_EQUAL(tasks[2].transaction.status, TW_MT_SLA_NACK);
+    TWI_CHECK_EQUAL(tasks[3].state, TWI_TASK_ERROR);
+    TWI_CHECK_EQUAL(tasks[3].transaction.status, TW_MT_DATA_NACK);
+    TWI_CHECK_EQUAL(writtenCount, 2 + 1);  /**< The refused byte never arrives. */
+    TWI_CHECK_EQUAL(written[2], 3);  /**< In the order the tasks asked for the bus. */
+
+    /* A finished task reports its outcome again until it is set back to ready. */
+    TWI_CHECK_EQUAL(TWI0.poll(&tasks[0]), TWI_TASK_DONE);
+    TWI_CHECK_EQUAL(TWI0.poll(&tasks[2]), TWI_TASK_ERROR);
+    TWI_CHECK_EQUAL(writtenCount, 3);
+    tasks[0].state = TWI_TASK_READY;
+    runAll(tasks, 1, 1000);
+    TWI_CHECK_EQUAL(tasks[0].state, TWI_TASK_DONE);
+    TWI_CHECK_EQUAL(writtenCount, 3 + 2);
+
+    /* With the queue full, a task stays ready and is submitted on a later call. */
+    TWI_Task many[TWI_QUEUE_SIZE + 2];
+    for (uint8_t i = 0; i < TWI_QUEUE_SIZE + 2; i++)
+        many[i] = TWI_Task{{0x50, data, 1}};
+    TWI_Transaction spare[TWI_QUEUE_SIZE + 1];
+    for (uint8_t i = 0; i <= TWI_QUEUE_SIZE; i++)  /**< One on the bus, the rest queued. */
+    {
+        spare[i] = TWI_Transaction{0x50, data, 1};
+        TWI_CHECK_EQUAL(TWI0.enqueue(&spare[i]), 1);
+    }
+    TWI_CHECK_EQUAL(TWI0.poll(&many[0]), TWI_TASK_PENDING);
+    TWI_CHECK_EQUAL(many[0].state, TWI_TASK_READY);
+    runAll(many, TWI_QUEUE_SIZE + 2, 1000);
+    for (uint8_t i = 0; i < TWI_QUEUE_SIZE + 2; i++)
+        TWI_CHECK_EQUAL(many[i].state, TWI_TASK_DONE);
+
+    /* A slave cannot run it. */
+    TWI0.end();
+    TWI0.begin((uint8_t)0x42);
+    tasks[0].state = TWI_TASK_READY;
+    TWI_CHECK_EQUAL(TWI0.poll(&tasks[0]), TWI_TASK_ERROR);
+
+    return (TWI_TEST_RESULT());
+}